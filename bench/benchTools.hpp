@@ -0,0 +1,71 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+#ifndef BENCHTOOLS_HPP
+#define BENCHTOOLS_HPP
+
+// Helpers shared by the check/benchmark programs in this directory (see README.md)
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+/**
+ * Wall-clock time of a call
+ * @param f function to be called
+ * @return  elapsed time (sec)
+ */
+template <class F> inline double timeIt(F f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Best wall-clock time of repeated calls
+ * @param reps # of calls
+ * @param f    function to be called
+ * @return     minimum elapsed time over all calls (sec)
+ */
+template <class F> inline double bestTimeOf(const int reps, F f) {
+    double best = timeIt(f);
+    for (int r = 1; r < reps; r++) best = std::min(best, timeIt(f));
+    return best;
+}
+
+/**
+ * Bitwise equality of two values
+ */
+inline bool identical(const double a, const double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+/**
+ * Bitwise equality of two vectors
+ */
+inline bool identical(const std::vector<double>& a, const std::vector<double>& b) {
+    return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(double)) == 0);
+}
+
+/**
+ * Print the outcome of a check
+ * @param mismatch # of mismatches found
+ * @return         exit code of the check (nonzero if any mismatch)
+ */
+inline int reportMismatches(const int mismatch) {
+    std::cout << (mismatch ? "FAILED: " : "OK: ") << mismatch << " mismatches\n";
+    return (mismatch != 0);
+}
+
+#endif
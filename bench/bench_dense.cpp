@@ -0,0 +1,147 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+/*
+ * Check and microbenchmark of the built-in dense simplex against CPLEX on random LPs of the
+ * kind solved over uncertainty sets (bounded parameters, dense inequality rows), for a range
+ * of sizes. Both solvers see each LP as they do in UncertaintySet: the dense simplex builds
+ * its tableau from scratch for every objective, CPLEX keeps the problem object and warm-starts
+ * from the previous basis. The crossover of the two timings is where DENSE_SIMPLEX_MAX_ROWS
+ * (uncertainty.cpp) should be. Optimal values must agree up to 1e-6 (relative).
+ * Returns nonzero if any result differs.
+ *
+ * usage: bench_dense [no. of columns per row] [no. of objectives per LP] [seed]
+ */
+
+#include "denseSimplex.hpp"
+#include "benchTools.hpp"
+#include <ilcplex/cplexx.h>
+#include <random>
+#include <numeric>
+#include <cstdio>
+
+namespace {
+
+const double DENSITY = 0.3;	// fraction of nonzeros in the rows
+
+/* Random LP: max c'x s.t. Ax <= b, -1 <= x <= 1, feasible at a random interior point */
+struct RandomLP {
+	int m, n;
+	std::vector<double> A, b;
+
+	RandomLP(std::mt19937& gen, const int m_, const int n_) : m(m_), n(n_), A(m_ * n_, 0.0), b(m_, 0.0) {
+		std::uniform_real_distribution<double> val(-1, 1), unit(0, 1);
+		std::vector<double> x0(n);
+		for (auto& v : x0) v = 0.5 * val(gen);
+		for (int r = 0; r < m; r++) {
+			for (int j = 0; j < n; j++) if (unit(gen) < DENSITY) A[r * n + j] = val(gen);
+			for (int j = 0; j < n; j++) b[r] += A[r * n + j] * x0[j];
+			b[r] += 0.1 * unit(gen);
+		}
+	}
+};
+
+double solveDense(DenseSimplex& lp, const RandomLP& P, const std::vector<double>& c) {
+	lp.reset(P.n, CPX_INFBOUND);
+	for (int j = 0; j < P.n; j++) lp.setColumn(j, c[j], -1.0, 1.0);
+	for (int r = 0; r < P.m; r++) lp.addRow(&P.A[r * P.n], 'L', P.b[r]);
+	if (lp.solve() != DenseSimplex::OPTIMAL) return std::numeric_limits<double>::quiet_NaN();
+	return lp.getObjValue();
+}
+
+CPXLPptr buildCplex(CPXENVptr env, const RandomLP& P) {
+	int status;
+	CPXLPptr lp = CPXXcreateprob(env, &status, "bench");
+	if (!lp) throw(status);
+	const std::vector<double> obj(P.n, 0.0), lb(P.n, -1.0), ub(P.n, 1.0);
+	CPXXnewcols(env, lp, P.n, &obj[0], &lb[0], &ub[0], NULL, NULL);
+	std::vector<CPXNNZ> rmatbeg;
+	std::vector<CPXDIM> rmatind;
+	std::vector<double> rmatval;
+	for (int r = 0; r < P.m; r++) {
+		rmatbeg.emplace_back(rmatind.size());
+		for (int j = 0; j < P.n; j++) if (P.A[r * P.n + j] != 0.0) {
+			rmatind.emplace_back(j);
+			rmatval.emplace_back(P.A[r * P.n + j]);
+		}
+	}
+	const std::vector<char> sense(P.m, 'L');
+	if (CPXXaddrows(env, lp, 0, P.m, rmatind.size(), &P.b[0], &sense[0], &rmatbeg[0], rmatind.data(), rmatval.data(), NULL, NULL)) throw(1);
+	CPXXchgobjsen(env, lp, CPX_MAX);
+	return lp;
+}
+
+double solveCplex(CPXENVptr env, CPXLPptr lp, const std::vector<double>& c, std::vector<CPXDIM>& cols) {
+	CPXXchgobj(env, lp, c.size(), &cols[0], &c[0]);
+	CPXXlpopt(env, lp);
+	if (CPXXgetstat(env, lp) != CPX_STAT_OPTIMAL) return std::numeric_limits<double>::quiet_NaN();
+	double val;
+	CPXXgetobjval(env, lp, &val);
+	return val;
+}
+
+}
+
+int main (int argc, char** argv) {
+
+	const double ratio = (argc > 1) ? std::atof(argv[1]) : 1.0;
+	const int numObj   = (argc > 2) ? std::atoi(argv[2]) : 20;
+	const int seed     = (argc > 3) ? std::atoi(argv[3]) : 0;
+
+	try {
+		int status;
+		CPXENVptr env = CPXXopenCPLEX(&status);
+		if (!env) throw(status);
+		CPXXsetintparam(env, CPXPARAM_ScreenOutput, CPX_OFF);
+		CPXXsetintparam(env, CPXPARAM_Threads, 1);
+
+		std::mt19937 gen(seed);
+		std::uniform_real_distribution<double> val(-1, 1);
+		DenseSimplex dense;
+		int mismatch = 0;
+
+		std::printf("%6s %6s %14s %14s\n", "rows", "cols", "dense (ms)", "CPLEX (ms)");
+		for (const int m : {10, 20, 30, 50, 75, 100, 150, 200}) {
+			const int n = std::max(1, (int)(ratio * m));
+			const RandomLP P(gen, m, n);
+			std::vector<std::vector<double> > objs(numObj, std::vector<double>(n));
+			for (auto& c : objs) for (auto& v : c) v = val(gen);
+
+			std::vector<double> outDense(numObj), outCplex(numObj);
+			const double tDense = timeIt([&]() {
+				for (int k = 0; k < numObj; k++) outDense[k] = solveDense(dense, P, objs[k]);
+			});
+
+			CPXLPptr lp = buildCplex(env, P);
+			std::vector<CPXDIM> cols(n);
+			std::iota(cols.begin(), cols.end(), 0);
+			const double tCplex = timeIt([&]() {
+				for (int k = 0; k < numObj; k++) outCplex[k] = solveCplex(env, lp, objs[k], cols);
+			});
+			CPXXfreeprob(env, &lp);
+
+			for (int k = 0; k < numObj; k++) {
+				if (std::abs(outDense[k] - outCplex[k]) <= 1.E-6 * (1.0 + std::abs(outCplex[k]))) continue;
+				std::cerr << "  mismatch (" << m << " x " << n << ", objective " << k << "): " << outDense[k] << " vs " << outCplex[k] << "\n";
+				mismatch++;
+			}
+			std::printf("%6d %6d %14.4f %14.4f\n", m, n, 1.E3 * tDense / numObj, 1.E3 * tCplex / numObj);
+		}
+
+		CPXXcloseCPLEX(&env);
+		return reportMismatches(mismatch);
+	}
+	catch (const int& e) {
+		std::cerr << "Program ABORTED: Error number " << e << "\n";
+		return 1;
+	}
+}
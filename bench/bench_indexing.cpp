@@ -0,0 +1,408 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+/*
+ * Check and timing of the VarTypeHandle queries of VarInfo:
+ *   - equivalence of the string API, the handle API and the original name/tuple-based
+ *     lookups over random var types (1 to 5 indices) with random undefined variables
+ *   - time of makeConsX() and makeConsY() of a knapsack instance with N items, with the
+ *     variable indices looked up by handle (KAdaptableInfo_KNP_DD) and by name (as before)
+ * Returns nonzero if any query or constraint differs.
+ *
+ * usage: bench_indexing [N] [no. of random var infos] [seed]
+ */
+
+#include "indexingTools.h"
+#include "problemInfo_knp_dd.hpp"
+#include "instance_knp.hpp"
+#include "benchTools.hpp"
+#include <random>
+
+// options of the knapsack model (as in problemInfo_knp_dd.cpp)
+#define CSTR_UNC 1
+#define USE_SINGLE 1
+#define USE_DRO 1
+#define USE_FEAS_W 1
+
+namespace {
+
+// Original queries, straight from the name -> tuple map
+
+int refVarLinIndex(const VarInfo& X, const std::string& type, const int ind1, const int ind2 = -1, const int ind3 = -1, const int ind4 = -1, const int ind5 = -1) {
+	return X.xdIndicesToLinIndex(X.VarType.at(type), ind1, ind2, ind3, ind4, ind5);
+}
+
+void refVarInfo(const VarInfo& X, const int linIndex, std::string& type, int& ind1, int& ind2, int& ind3, int& ind4, int& ind5) {
+	type.clear();
+	for (const auto& T : X.VarType) if (linIndex >= std::get<0>(T.second) && linIndex <= std::get<1>(T.second)) {
+		type = T.first;
+		X.linToIndex(linIndex, T.second, ind1, ind2, ind3, ind4, ind5);
+	}
+}
+
+int refDefVarTypeSize(const VarInfo& X, const std::string& name) {
+	if (X.VarType.find(name) == X.VarType.end()) return 0;
+	const int first = std::get<0>(X.VarType.at(name)), last = std::get<1>(X.VarType.at(name));
+	return last - first + 1 - X.UndefinedVarCount[last] + (first >= 1 ? X.UndefinedVarCount[first - 1] : 0);
+}
+
+int refFirstDefOfVarType(const VarInfo& X, const std::string& name) {
+	int first = std::get<0>(X.VarType.at(name));
+	while (X.UndefinedVar[first]) first++;
+	return first;
+}
+
+int refLastDefOfVarType(const VarInfo& X, const std::string& name) {
+	int last = std::get<1>(X.VarType.at(name));
+	while (X.UndefinedVar[last]) last--;
+	return last - X.UndefinedVarCount[last];
+}
+
+// Random var types with 1 to 5 indices; every var is undefined with probability 1/4,
+// except for one var per type (the first/last defined var queries require one)
+void randomVarInfo(std::mt19937& gen, VarInfo& X, std::vector<std::string>& names) {
+	std::uniform_int_distribution<int> ntypes(1, 6), ndims(1, 5), dimsize(1, 6);
+	X.clear();
+	names.clear();
+	for (int t = ntypes(gen); t > 0; t--) {
+		int sizes[5] = {-1, -1, -1, -1, -1};
+		for (int d = ndims(gen) - 1; d >= 0; d--) sizes[d] = dimsize(gen);
+		names.emplace_back("v" + std::to_string(names.size()));
+		const VarTypeHandle h = X.addVarType(names.back(), (gen() % 2) ? 'B' : 'C', 0, 1, sizes[0], sizes[1], sizes[2], sizes[3], sizes[4]);
+		const int keep = X.getFirstOfVarType(h) + gen() % X.getVarTypeSize(h);
+		for (int i = X.getFirstOfVarType(h); i <= X.getLastOfVarType(h); i++) if (i != keep && gen() % 4 == 0) X.setUndefinedVar(i);
+	}
+}
+
+int checkVarInfo(const VarInfo& X, const std::vector<std::string>& names) {
+	int mismatch = 0;
+	auto expect = [&mismatch](const bool ok, const std::string& what, const std::string& name) {
+		if (!ok) { std::cerr << "  mismatch in " << what << " of " << name << "\n"; mismatch++; }
+	};
+
+	for (const auto& name : names) {
+		const VarTypeHandle h = X.getVarTypeHandle(name);
+		expect(h.isValid() && X.getVarTypeName(h) == name, "getVarTypeHandle", name);
+		expect(X.getVarTypeSize(name) == X.getVarTypeSize(h) && X.getVarTypeSize(h) == std::get<1>(X.VarType.at(name)) - std::get<0>(X.VarType.at(name)) + 1, "getVarTypeSize", name);
+		expect(X.getDefVarTypeSize(name) == X.getDefVarTypeSize(h) && X.getDefVarTypeSize(h) == refDefVarTypeSize(X, name), "getDefVarTypeSize", name);
+		expect(X.getFirstOfVarType(name) == X.getFirstOfVarType(h) && X.getFirstOfVarType(h) == std::get<0>(X.VarType.at(name)), "getFirstOfVarType", name);
+		expect(X.getLastOfVarType(name) == X.getLastOfVarType(h) && X.getLastOfVarType(h) == std::get<1>(X.VarType.at(name)), "getLastOfVarType", name);
+		expect(X.getFirstDefOfVarType(name) == X.getFirstDefOfVarType(h) && X.getFirstDefOfVarType(h) == refFirstDefOfVarType(X, name), "getFirstDefOfVarType", name);
+		expect(X.getLastDefOfVarType(name) == X.getLastDefOfVarType(h) && X.getLastDefOfVarType(h) == refLastDefOfVarType(X, name), "getLastDefOfVarType", name);
+
+		// every var of the type, from its indices and back
+		for (int i = X.getFirstOfVarType(h); i <= X.getLastOfVarType(h); i++) {
+			std::string type, refType;
+			int ind[5], ref[5];
+			X.getVarInfo(i, type, ind[0], ind[1], ind[2], ind[3], ind[4]);
+			refVarInfo(X, i, refType, ref[0], ref[1], ref[2], ref[3], ref[4]);
+			expect(type == refType && std::equal(ind, ind + 5, ref), "getVarInfo", name);
+			expect(X.getVarName(i) == name && X.getVarTypeOf(i).id == h.id, "getVarName/getVarTypeOf", name);
+
+			const int lin = X.getVarLinIndex(h, ind[0], ind[1], ind[2], ind[3], ind[4]);
+			expect(lin == i && X.getVarLinIndex(name, ind[0], ind[1], ind[2], ind[3], ind[4]) == lin && refVarLinIndex(X, name, ind[0], ind[1], ind[2], ind[3], ind[4]) == lin, "getVarLinIndex", name);
+			if (!X.isUndefVar(i)) {
+				const int def = X.getDefVarLinIndex(h, ind[0], ind[1], ind[2], ind[3], ind[4]);
+				expect(def == i - X.UndefinedVarCount[i] && X.getDefVarLinIndex(name, ind[0], ind[1], ind[2], ind[3], ind[4]) == def && X.getDefVarLinIndex(i) == def, "getDefVarLinIndex", name);
+			}
+		}
+	}
+
+	// unknown var type
+	expect(!X.getVarTypeHandle("undefined").isValid() && X.getDefVarTypeSize("undefined") == 0 && X.getDefVarTypeSize(X.getVarTypeHandle("undefined")) == 0, "unknown var type", "undefined");
+
+	return mismatch;
+}
+
+
+/*
+ * Knapsack problem with decision-dependent information discovery whose constraints are built by
+ * var type name, as before the var type handles were introduced: makeConsX() and makeConsY()
+ * are copies of those of KAdaptableInfo_KNP_DD with each handle replaced by the name of its type.
+ */
+class KAdaptableInfo_KNP_DD_ByName : public KAdaptableInfo_KNP_DD {
+protected:
+	void makeConsX() override;
+	void makeConsY(unsigned int k = 0) override;
+};
+
+//-----------------------------------------------------------------------------------
+
+void KAdaptableInfo_KNP_DD_ByName::makeConsX() {
+	ConstraintExpression temp;
+
+	/////////
+	// B_X //
+	/////////
+	B_X.clear();
+
+	// bounds on w(i)
+	for (int i = 0; i <= data.N-1; ++i) {
+		temp.clear();
+		temp.addTermX(getVarIndex_1("w", i), 1);
+
+		temp.rowname(modelName("LB_w", i));
+		temp.sign('G');
+		temp.RHS(0);
+		B_X.emplace_back(temp);
+
+		temp.rowname(modelName("UB_w", i));
+		temp.sign('L');
+		temp.RHS(1);
+		B_X.emplace_back(temp);
+	}
+
+
+
+	/////////
+	// C_X //
+	/////////
+	C_X.clear();
+
+
+	//////////
+	// C_XQ //
+	//////////
+	C_XQ.clear();
+
+	// nothing to do
+}
+
+//-----------------------------------------------------------------------------------
+
+void KAdaptableInfo_KNP_DD_ByName::makeConsY(unsigned int l) {
+	assert(C_XY.size() == B_Y.size());
+	assert(C_XY.size() == C_XYQ.size());
+	assert(numPolicies >= l);
+	if (l == 0) {
+		B_Y.clear();
+		C_XY.clear();
+		C_XYQ.clear();
+	}
+	ConstraintExpression temp;
+
+	/////////
+	// B_Y //
+	/////////
+	for (unsigned int k = B_Y.size(); k <= l; k++) {
+		if (B_Y.size() < k + 1) B_Y.resize(k + 1);
+
+		B_Y[k].clear();
+
+		// bounds on y(i)
+		for (int i = 0; i <= data.N-1; ++i) {
+			temp.clear();
+			temp.addTermX(getVarIndex_2(k, "y", i), 1);
+
+			temp.rowname(modelName("LB_y", i, k));
+			temp.sign('G');
+			temp.RHS(0);
+			B_Y[k].emplace_back(temp);
+
+			temp.rowname(modelName("UB_y", i, k));
+			temp.sign('L');
+			temp.RHS(1);
+			B_Y[k].emplace_back(temp);
+		}
+	}
+
+
+	//////////
+	// C_XY //
+	//////////
+	for (unsigned int k = C_XY.size(); k <= l; k++) {
+		if (C_XY.size() < k + 1) C_XY.resize(k + 1);
+
+		C_XY[k].clear();
+
+		// invest early or invest late
+		for (int i = 0; i <= data.N-1; ++i) {
+			temp.clear();
+			temp.rowname(modelName("EITHER", i, k));
+			temp.sign('L');
+			temp.RHS(1.0);
+			temp.addTermX(getVarIndex_1("w", i), 1.0);
+			temp.addTermX(getVarIndex_2(k, "y", i), 1.0);
+			
+			C_XY[k].emplace_back(temp);
+            //temp.print();
+		}
+        
+        // deterministic cost constraint
+        if(!CSTR_UNC){
+            temp.clear();
+            for (int i = 0; i <= data.N-1; ++i) if (data.cost[i] != 0.0) {
+                temp.rowname(modelName("BUDGET", k));
+                temp.sign('L');
+                temp.RHS(data.B);
+                temp.addTermX(getVarIndex_1("w", i), data.cost[i]);
+                temp.addTermX(getVarIndex_2(k, "y", i), data.cost[i]);
+            }
+            C_XY[k].emplace_back(temp);
+            //temp.print();
+            if(USE_FEAS_W){
+                temp.clear();
+                for (int i = 0; i <= data.N-1; ++i) if (data.cost[i] != 0.0) {
+                    temp.rowname(modelName("BUDGET_W", k));
+                    temp.sign('L');
+                    temp.RHS(data.B);
+                    temp.addTermX(getVarIndex_1("w", i), data.cost[i]);
+                }
+                C_X.emplace_back(temp);
+            }
+        }
+	}	
+
+		
+	///////////
+	// C_XYQ //
+	///////////
+	for (unsigned int k = C_XYQ.size(); k <= l; k++) {
+		if (C_XYQ.size() < k + 1) C_XYQ.resize(k + 1);
+		
+		C_XYQ[k].clear();
+
+		// objective function
+        
+        double nomProfit = 0.0;
+        double nomCost = 0.0;
+		temp.clear();
+		temp.rowname(modelName("OBJ_CONSTRAINT", k));
+		temp.sign('G');
+		temp.RHS(0);
+		temp.addTermX(getVarIndex_1("O", 0), 1);
+		for (int i = 0; i <= data.N-1; ++i){
+            temp.addTermProduct(getVarIndex_1("w", i), data.phi[0].size() + i, 1.0);
+            // temp.addTermX(getVarIndex_1("w", i), -data.profit[i]);
+            // C_W[i] = -data.profit[i];
+            temp.addTermProduct(getVarIndex_2(k, "y", i), data.phi[0].size() + i, data.theta);
+            nomProfit += data.profit[i];
+            nomCost += data.cost[i];
+		}
+        if(USE_DRO){
+            temp.addTermProduct(getVarIndex_1("psi", 0), data.phi[0].size() + (1+CSTR_UNC)*data.N, 1.0);
+            temp.addTermX(getVarIndex_1("psi", 0), -0.15*nomProfit/sqrt(data.N));
+            
+            if(CSTR_UNC){
+                temp.addTermProduct(getVarIndex_1("psi", 1), data.phi[0].size() + (1+CSTR_UNC)*data.N + 1, 1.0);
+                temp.addTermX(getVarIndex_1("psi", 1), -0.15*nomCost/sqrt(data.N));
+            }
+            
+            if(USE_SINGLE){
+                for (int i = 0; i <= data.N-1; ++i)
+                {
+                    temp.addTermProduct(getVarIndex_1("psi", i + 1 + CSTR_UNC), data.phi[0].size() + (1+CSTR_UNC)*(data.N + 1) + i, 1.0);
+                    temp.addTermX(getVarIndex_1("psi", i + 1 + CSTR_UNC), -0.15*data.profit[i]);
+                }
+                
+                if(CSTR_UNC){
+                    for (int i = 0; i <= data.N-1; ++i)
+                    {
+                        temp.addTermProduct(getVarIndex_1("psi", i + 1 + CSTR_UNC + data.N), data.phi[0].size() + (2+CSTR_UNC)*data.N + 1 + CSTR_UNC + i, 1.0);
+                        temp.addTermX(getVarIndex_1("psi", i + 1 + CSTR_UNC + data.N), -0.15*data.cost[i]);
+                    }
+                }
+            }
+            
+        }
+        
+		C_XYQ[k].emplace_back(temp);
+        //C_XYQ[k][0].print();
+
+		// budget
+        if(CSTR_UNC){
+            temp.clear();
+            temp.rowname(modelName("BUDGET", k));
+            temp.sign('L');
+            temp.RHS(data.B);
+            for (int i = 0; i <= data.N-1; ++i){
+                temp.addTermProduct(getVarIndex_1("w", i), data.phi[0].size() + + data.N + i, 1.0);
+                temp.addTermProduct(getVarIndex_2(k, "y", i), data.phi[0].size() + + data.N + i, 1.0);
+            }
+            C_XYQ[k].emplace_back(temp);
+            
+            if(k==0){
+                if(USE_FEAS_W){
+                    temp.clear();
+                    temp.rowname(modelName("BUDGET_W"));
+                    temp.sign('L');
+                    temp.RHS(data.B);
+                    for (int i = 0; i <= data.N-1; ++i){
+                        temp.addTermProduct(getVarIndex_1("w", i), data.phi[0].size() + + data.N + i, 1.0);
+                    }
+                    C_XQ.emplace_back(temp);
+                }
+            }
+        }
+	}
+}
+
+
+// Time of makeConsX() and makeConsY() of the given problem class, on an instance that has been set already
+template <class Info> struct TimedInfo : public Info {
+	double timeMakeCons(const int reps) {
+		return bestTimeOf(reps, [this]() { this->makeConsX(); this->makeConsY(0); });
+	}
+};
+
+// Constraints of both classes must have the same variables and coefficients
+int compareConstraints(const std::vector<ConstraintExpression>& a, const std::vector<ConstraintExpression>& b, const std::string& what) {
+	int mismatch = (a.size() != b.size());
+	for (size_t c = 0; !mismatch && c < a.size(); c++)
+		mismatch += (a[c].getVarIndices() != b[c].getVarIndices() || a[c].getVarCoeffs() != b[c].getVarCoeffs());
+	if (mismatch) std::cerr << "  mismatch in " << what << " of the model built by name\n";
+	return mismatch;
+}
+
+}
+
+int main (int argc, char** argv) {
+
+	const int N       = (argc > 1) ? std::atoi(argv[1]) : 1000;
+	const int numInfo = (argc > 2) ? std::atoi(argv[2]) : 200;
+	const int seed    = (argc > 3) ? std::atoi(argv[3]) : 0;
+	const int reps    = 5;
+
+	int mismatch = 0;
+
+	// equivalence over random var types
+	std::mt19937 gen(seed);
+	VarInfo X;
+	std::vector<std::string> names;
+	for (int r = 0; r < numInfo; r++) {
+		randomVarInfo(gen, X, names);
+		mismatch += checkVarInfo(X, names);
+	}
+	std::cout << "equivalence: " << numInfo << " random var infos, " << mismatch << " mismatches\n";
+
+	// construction of the constraints of a large knapsack instance, by name and by handle
+	KNP data;
+	gen_KNP(data, N, seed);
+	TimedInfo<KAdaptableInfo_KNP_DD_ByName> byName;
+	TimedInfo<KAdaptableInfo_KNP_DD> byHandle;
+	byName.setInstance(data);
+	byHandle.setInstance(data);
+	const double tName   = byName.timeMakeCons(reps);
+	const double tHandle = byHandle.timeMakeCons(reps);
+
+	mismatch += compareConstraints(byName.getBoundsX(), byHandle.getBoundsX(), "B_X");
+	mismatch += compareConstraints(byName.getBoundsY()[0], byHandle.getBoundsY()[0], "B_Y");
+	mismatch += compareConstraints(byName.getConstraintsX(), byHandle.getConstraintsX(), "C_X");
+	mismatch += compareConstraints(byName.getConstraintsXY()[0], byHandle.getConstraintsXY()[0], "C_XY");
+	mismatch += compareConstraints(byName.getConstraintsXQ(), byHandle.getConstraintsXQ(), "C_XQ");
+	mismatch += compareConstraints(byName.getConstraintsXYQ()[0], byHandle.getConstraintsXYQ()[0], "C_XYQ");
+
+	std::cout << "makeConsX + makeConsY, knapsack N = " << N << " (best of " << reps << "):\n";
+	std::cout << "  by name " << tName << " s, by handle " << tHandle << " s, speedup " << tName / tHandle << "\n";
+
+	return reportMismatches(mismatch);
+}
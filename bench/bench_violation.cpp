@@ -0,0 +1,299 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+/*
+ * Check and microbenchmark of getViolation() on random constraints, against a copy of the
+ * evaluation of a single-policy KAdaptableExpression as it was before getSeparationRow()
+ * and getViolation_LE() were introduced (RefConstraint below):
+ *   - fixed (x, q):   getViolation(con, x, q)        vs  RefConstraint::evaluate(q, x)
+ *   - worst-case q:   getViolation(con, U, x, q)     vs  RefConstraint::evaluate(U, x)
+ * Results must agree bit for bit. Returns nonzero if any result differs.
+ *
+ * usage: bench_violation [no. of constraints] [no. of evaluations per constraint] [seed]
+ */
+
+#include "constraintExpr.hpp"
+#include "uncertainty.hpp"
+#include "benchTools.hpp"
+#include <random>
+
+namespace {
+
+const int NX = 50;		// no. of decision variables
+const int NQ = 20;		// no. of uncertain parameters
+
+/*
+ * Terms of a constraint, stored in the same order as ConstraintExpression stores them (the
+ * members of ConstraintExpression are private), and the evaluation code of
+ * KAdaptableExpression::evaluate() before it was rewritten on top of getSeparationRow(),
+ * specialized to a single policy (Expr[p] --> exp).
+ */
+struct RefConstraint {
+	char sense;
+	double rhs;
+	std::vector<int> varIndices, paramIndices;
+	std::vector<double> varCoeffs, paramCoeffs, bilinearCoeffs;
+	std::vector<std::pair<int, int> > bilinearIndices;
+
+	static void addTerm(const int ind, const double val, std::vector<int>& vec1, std::vector<double>& coeffs) {
+		if (val == 0.0) return;
+		const int Pos = std::find(vec1.begin(), vec1.end(), ind) - vec1.begin();
+		if (Pos >= (int)vec1.size()) { vec1.push_back(ind); coeffs.push_back(val); }
+		else coeffs.at(Pos) += val;
+	}
+	void addTermX(const int ind, const double val) { addTerm(ind, val, varIndices, varCoeffs); }
+	void addTermQ(const int ind, const double val) { addTerm(ind, val, paramIndices, paramCoeffs); }
+	void addTermProduct(const int xind, const int qind, const double coeff) {
+		if (coeff == 0.0) return;
+		if (std::find(varIndices.begin(), varIndices.end(), xind) == varIndices.end()) { varIndices.push_back(xind); varCoeffs.push_back(0); }
+		if (std::find(paramIndices.begin(), paramIndices.end(), qind) == paramIndices.end()) { paramIndices.push_back(qind); paramCoeffs.push_back(0); }
+		const std::pair<int, int> xq(xind, qind);
+		const int curPos = std::find(bilinearIndices.begin(), bilinearIndices.end(), xq) - bilinearIndices.begin();
+		if (curPos >= (int)bilinearIndices.size()) { bilinearIndices.emplace_back(xq); bilinearCoeffs.emplace_back(coeff); }
+		else bilinearCoeffs.at(curPos) += coeff;
+	}
+
+	/* Convert to <= form (as done by the constructor of KAdaptableExpression) */
+	RefConstraint toLE() const {
+		RefConstraint exp(*this);
+		if (exp.sense == 'G') {
+			exp.sense = 'L';
+			exp.rhs *= (-1.0);
+			for (auto& c : exp.varCoeffs)      c *= (-1.0);
+			for (auto& b : exp.paramCoeffs)    b *= (-1.0);
+			for (auto& S : exp.bilinearCoeffs) S *= (-1.0);
+		}
+		return exp;
+	}
+
+	bool isEmpty() const {
+		for (const auto& i : varCoeffs) if (i != 0.0) return false;
+		for (const auto& i : bilinearCoeffs) if (i != 0.0) return false;
+		return true;
+	}
+	bool existConstQTerms() const {
+		for (const auto& i : paramCoeffs) if (i != 0.0) return true;
+		return false;
+	}
+	bool existBilinearTerms() const {
+		for (const auto& i : bilinearCoeffs) if (i != 0.0) return true;
+		return false;
+	}
+
+	/* Deterministic case: value at the supplied q */
+	double evaluate(const std::vector<double>& paramValues, const std::vector<double>& varValues, const bool normalized) const {
+		const RefConstraint exp = toLE();
+		const bool qTermsInProduct = exp.existBilinearTerms();
+		const bool qTermsConst     = exp.existConstQTerms();
+		const bool xTermsConst     = !exp.isEmpty();
+
+		/* Value of the {...} term in max_q min_p {...} */
+		double ExprEval = 0.0;
+
+		/* Normalized value --> quantity dividing the {...} term in max_q min_p {...} */
+		double Normalization = (normalized ? 0.0 : 1.0);
+
+		/* -d(p) */
+		ExprEval += -exp.rhs;
+
+		/* +bq* */
+		if(qTermsConst)
+			for(size_t i=0; i<exp.paramCoeffs.size(); i++) {
+				const double t = exp.paramCoeffs[i];
+				ExprEval += t * paramValues.at(exp.paramIndices.at(i));
+				if (normalized) Normalization += t * t;
+			}
+
+		/* +cx*(p) */
+		if(xTermsConst)
+			for(size_t i=0; i<exp.varCoeffs.size(); i++)
+				ExprEval += exp.varCoeffs[i]*varValues.at(exp.varIndices.at(i));
+
+		/* +x*(p)Sq* */
+		if(qTermsInProduct)
+			for(size_t i=0; i<exp.bilinearCoeffs.size(); i++) {
+				const double t = exp.bilinearCoeffs[i]*varValues.at(exp.bilinearIndices.at(i).first);
+				ExprEval += t * paramValues.at(exp.bilinearIndices.at(i).second);
+				if (normalized) Normalization += t * t;
+			}
+
+		if (normalized) {
+			assert(Normalization != 0.0);
+			ExprEval /= std::sqrt(Normalization);
+		}
+
+		return ExprEval;
+	}
+
+	/* Uncertain case: worst-case q through the separation LP of the uncertainty set */
+	std::vector<double> evaluate(UNCSetCPtr UncSet, const std::vector<double>& varValues, const bool normalized) const {
+		const RefConstraint exp = toLE();
+		const bool qTermsInProduct = exp.existBilinearTerms();
+		const bool xTermsConst     = !exp.isEmpty();
+
+		const int N = UncSet->getNoOfUncertainParameters();
+
+		std::vector<std::vector<int> > rowInd(1);
+		std::vector<std::vector<double> > rowVal(1);
+		std::vector<double> rowRhs(1, 0.0);
+		std::vector<double> coef(1 + N, 0.0);
+
+		const size_t p = 0;
+		{
+			auto& ind = rowInd[p];
+
+			/* -d(p) + cx*(p) */
+			rowRhs[p] = -exp.rhs; if (xTermsConst) for (size_t i = 0; i < exp.varCoeffs.size(); i++) rowRhs[p] += exp.varCoeffs[i] * varValues.at(exp.varIndices.at(i));
+
+			/* Normalized value --> quantity dividing the {...} term in max_q min_p {...} */
+			double Normalization = (normalized ? 0.0 : 1.0);
+
+			/* -bq */
+			for (size_t i = 0; i < exp.paramCoeffs.size(); i++) if (exp.paramCoeffs[i] != 0.0) {
+				ind.push_back(exp.paramIndices[i]);
+				coef.at(exp.paramIndices[i]) -= exp.paramCoeffs[i];
+				if (normalized) Normalization += exp.paramCoeffs[i] * exp.paramCoeffs[i];
+			}
+
+			/* -x*Sq */
+			if (qTermsInProduct) for (size_t i = 0; i < exp.bilinearCoeffs.size(); i++) if (exp.bilinearCoeffs[i] != 0.0) {
+				const double t = (exp.bilinearCoeffs[i] * varValues.at(exp.bilinearIndices[i].first));
+				ind.push_back(exp.bilinearIndices[i].second);
+				coef.at(exp.bilinearIndices[i].second) -= t;
+				if (normalized) Normalization += t * t;
+			}
+
+			/* \tau */
+			std::sort(ind.begin(), ind.end());
+			ind.erase(std::unique(ind.begin(), ind.end()), ind.end());
+			ind.insert(ind.begin(), 0);
+			coef[0] = std::sqrt(Normalization);
+
+			rowVal[p].reserve(ind.size());
+			for (const auto& j : ind) { rowVal[p].push_back(coef[j]); coef[j] = 0.0; }
+		}
+
+		/* Solve LP */
+		std::vector<double> primalX;
+		const int lpstat = UncSet->solveSeparationLP(rowInd, rowVal, rowRhs, primalX);
+		if (lpstat != CPX_STAT_OPTIMAL) {
+			std::cerr << "\n\n Could not solve LP to optimality inside the evaluation problem of K-adaptable expression." << lpstat << "\n\n";
+			exit(-2);
+		}
+
+		return primalX;
+	}
+};
+
+// Random <= or >= constraint with linear, parameter and bilinear terms (at least one q term),
+// built both as a ConstraintExpression and as its reference copy
+void randomConstraint(std::mt19937& gen, const int id, ConstraintExpression& con, RefConstraint& ref) {
+	std::uniform_real_distribution<double> coef(-5, 5);
+	std::uniform_int_distribution<int> xind(0, NX - 1), qind(1, NQ), nterms(1, 8);
+
+	ref = RefConstraint();
+	ref.sense = (gen() % 2) ? 'L' : 'G';
+	ref.rhs = coef(gen);
+	con = ConstraintExpression("c" + std::to_string(id), ref.sense, ref.rhs);
+	for (int t = nterms(gen); t > 0; t--) { const int i = xind(gen); const double c = coef(gen); con.addTermX(i, c); ref.addTermX(i, c); }
+	for (int t = nterms(gen); t > 0; t--) { const int i = qind(gen); const double c = coef(gen); con.addTermQ(i, c); ref.addTermQ(i, c); }
+	if (gen() % 2) for (int t = nterms(gen); t > 0; t--) {
+		const int i = xind(gen), j = qind(gen); const double c = coef(gen);
+		con.addTermProduct(i, j, c); ref.addTermProduct(i, j, c);
+	}
+}
+
+// Budget-constrained box around random nominal values
+void randomUncertaintySet(std::mt19937& gen, UncertaintySet& U) {
+	std::uniform_real_distribution<double> nom(-2, 2), dev(0.1, 1);
+	std::vector<std::pair<int, double> > budget;
+	double rhs = NQ / 4.0;
+	for (int i = 1; i <= NQ; i++) {
+		const double q = nom(gen), d = dev(gen);
+		U.addParam(q, q - d, q + d);
+		budget.emplace_back(i, 1.0);
+		rhs += q;
+	}
+	U.addFacet(budget, 'L', rhs);
+}
+
+}
+
+int main (int argc, char** argv) {
+
+	const int numCon  = (argc > 1) ? std::atoi(argv[1]) : 200;
+	const int numEval = (argc > 2) ? std::atoi(argv[2]) : 50;
+	const int seed    = (argc > 3) ? std::atoi(argv[3]) : 0;
+
+	try {
+		std::mt19937 gen(seed);
+		std::uniform_real_distribution<double> val(-1, 1);
+
+		std::vector<ConstraintExpression> cons(numCon);
+		std::vector<RefConstraint> refs(numCon);
+		for (int c = 0; c < numCon; c++) randomConstraint(gen, c, cons[c], refs[c]);
+
+		std::vector<std::vector<double> > xs(numEval, std::vector<double>(NX)), qs(numEval, std::vector<double>(1 + NQ));
+		for (auto& x : xs) for (auto& v : x) v = val(gen);
+		for (auto& q : qs) for (size_t i = 1; i < q.size(); i++) q[i] = val(gen);
+
+		// separate (identical) sets so that neither path reads results cached by the other
+		UncertaintySet U_ref, U_new;
+		{ std::mt19937 g(seed); randomUncertaintySet(g, U_ref); }
+		{ std::mt19937 g(seed); randomUncertaintySet(g, U_new); }
+
+		int mismatch = 0;
+
+		for (const bool normalized : {false, true}) {
+			std::cout << (normalized ? "normalized" : "absolute") << " violation, " << numCon << " constraints x " << numEval << " points\n";
+
+			// fixed (x, q)
+			std::vector<double> ref(numCon * numEval), out(numCon * numEval);
+			const double tRef = timeIt([&]() {
+				for (int c = 0; c < numCon; c++) for (int e = 0; e < numEval; e++)
+					ref[c * numEval + e] = refs[c].evaluate(qs[e], xs[e], normalized);
+			});
+			const double tNew = timeIt([&]() {
+				for (int c = 0; c < numCon; c++) for (int e = 0; e < numEval; e++)
+					out[c * numEval + e] = getViolation(cons[c], xs[e], qs[e], normalized);
+			});
+			for (size_t i = 0; i < ref.size(); i++) if (!identical(ref[i], out[i])) {
+				std::cerr << "  mismatch (fixed q) in " << cons[i / numEval].getName() << ": " << ref[i] << " vs " << out[i] << "\n";
+				mismatch++;
+			}
+			std::cout << "  fixed q:     reference " << tRef << " s, getViolation " << tNew << " s, speedup " << tRef / tNew << "\n";
+
+			// worst-case q
+			std::vector<std::vector<double> > qRef(numCon * numEval), qNew(numCon * numEval);
+			const double tRefU = timeIt([&]() {
+				for (int c = 0; c < numCon; c++) for (int e = 0; e < numEval; e++)
+					qRef[c * numEval + e] = refs[c].evaluate(&U_ref, xs[e], normalized);
+			});
+			const double tNewU = timeIt([&]() {
+				for (int c = 0; c < numCon; c++) for (int e = 0; e < numEval; e++)
+					getViolation(cons[c], &U_new, xs[e], qNew[c * numEval + e], normalized);
+			});
+			for (size_t i = 0; i < qRef.size(); i++) if (!identical(qRef[i], qNew[i])) {
+				std::cerr << "  mismatch (worst-case q) in " << cons[i / numEval].getName() << ": " << qRef[i][0] << " vs " << (qNew[i].empty() ? 0.0 : qNew[i][0]) << "\n";
+				mismatch++;
+			}
+			std::cout << "  worst-case:  reference " << tRefU << " s, getViolation " << tNewU << " s, speedup " << tRefU / tNewU << "\n";
+		}
+
+		return reportMismatches(mismatch);
+	}
+	catch (const int& e) {
+		std::cerr << "Program ABORTED: Error number " << e << "\n";
+	}
+
+	return 1;
+}
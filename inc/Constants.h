@@ -27,5 +27,17 @@
 #define TIME_LIMIT 7200
 #define MEMORY_LIMIT 3072
 #define NUM_THREADS 1
+#define MAX_SEPARATION_LPS 256 // Max # of persistent separation LPs per uncertainty set
+#define MAX_SEPARATION_CACHE 4096 // Max # of cached separation results per uncertainty set
+
+// Names of CPLEX rows and columns are generated only if set (needed to export models or
+// to read them while debugging); can be overridden at compile time with -DNAME_MODEL_ELEMENTS=0/1
+#ifndef NAME_MODEL_ELEMENTS
+#ifndef NDEBUG
+#define NAME_MODEL_ELEMENTS 1
+#else
+#define NAME_MODEL_ELEMENTS 0
+#endif
+#endif
 
 #endif
@@ -0,0 +1,358 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+#ifndef CONSTRAINTBLOCK_HPP
+#define CONSTRAINTBLOCK_HPP
+
+#include "constraintExpr.hpp"
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <iostream>
+
+class ConstraintBlock;
+
+/**
+ * Lightweight read-only view of a single row of a ConstraintBlock.
+ * Provides the evaluation functions of ConstraintExpression with identical results.
+ */
+class ConstraintRow {
+private:
+	const ConstraintBlock* B;
+	unsigned r;
+
+public:
+	ConstraintRow(const ConstraintBlock* block, const unsigned row) : B(block), r(row) {}
+
+	inline unsigned getIndex() const { return r; }
+	inline char getSense() const;
+	inline double getRHS() const;
+
+	/**
+	 * Violation of the row at fixed (x, q); same as getViolation(const ConstraintExpression&, x, q, normalized)
+	 */
+	inline double getViolation(const std::vector<double>& varValues, const std::vector<double>& paramValues = {}, const bool normalized = 0) const;
+
+	/**
+	 * Append the row for fixed q (coefficients of x) to the given arrays; same as ConstraintExpression::getDeterministicConstraint()
+	 * @return # of nonzeros appended
+	 */
+	inline CPXNNZ appendDeterministicConstraint(const std::vector<double>& paramValues, double& trueRhs, char& trueSense, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const;
+
+	/**
+	 * Append the row for fixed x (coefficients of q) to the given arrays; same as ConstraintExpression::getStochasticConstraint()
+	 * @return # of nonzeros appended
+	 */
+	inline CPXNNZ appendStochasticConstraint(const std::vector<double>& varValues, double& trueRhs, char& trueSense, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const;
+
+	inline void getDeterministicConstraint(const std::vector<double>& paramValues, CPXNNZ& nzcnt, double& trueRhs, char& trueSense, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const {
+		rmatind.clear();
+		rmatval.clear();
+		nzcnt = appendDeterministicConstraint(paramValues, trueRhs, trueSense, rmatind, rmatval);
+	}
+
+	inline void getStochasticConstraint(const std::vector<double>& varValues, CPXNNZ& nzcnt, double& trueRhs, char& trueSense, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const {
+		rmatind.clear();
+		rmatval.clear();
+		nzcnt = appendStochasticConstraint(varValues, trueRhs, trueSense, rmatind, rmatval);
+	}
+};
+
+/**
+ * Read-only family of constraints cx + bq + xSq [sense] d stored in compressed sparse row form:
+ * all rows share one array per kind of term (x-, q- and xq-terms, structure of arrays),
+ * delimited by row pointers. The xq-terms are additionally grouped by x-term and by q-term,
+ * so that the coefficients of a row for fixed q (or fixed x) are obtained in linear time.
+ * Names are not kept.
+ */
+class ConstraintBlock {
+	friend class ConstraintRow;
+
+private:
+	/** Sense, rhs and kinds of terms present (cx, bq, xSq) of each row */
+	std::vector<char> sense;
+	std::vector<double> rhs;
+	std::vector<char> hasX, hasQ, hasXQ;
+
+	/** x-terms of row r: [xBeg[r], xBeg[r+1]) */
+	std::vector<unsigned> xBeg;
+	std::vector<int> xInd;
+	std::vector<double> xVal;
+
+	/** q-terms of row r: [qBeg[r], qBeg[r+1]) */
+	std::vector<unsigned> qBeg;
+	std::vector<int> qInd;
+	std::vector<double> qVal;
+
+	/** xq-terms of row r: [xqBeg[r], xqBeg[r+1]) */
+	std::vector<unsigned> xqBeg;
+	std::vector<int> xqX, xqQ;
+	std::vector<double> xqVal;
+
+	/** Nonzero xq-terms of x-term k: [xGrpBeg[k], xGrpBeg[k+1]) (parameter index, coefficient) */
+	std::vector<unsigned> xGrpBeg;
+	std::vector<int> xGrpQ;
+	std::vector<double> xGrpVal;
+
+	/** Nonzero xq-terms of q-term k: [qGrpBeg[k], qGrpBeg[k+1]) (variable index, coefficient) */
+	std::vector<unsigned> qGrpBeg;
+	std::vector<int> qGrpX;
+	std::vector<double> qGrpVal;
+
+public:
+	/** Iterator over the rows of the block */
+	class const_iterator {
+		const ConstraintBlock* B;
+		unsigned r;
+	public:
+		const_iterator(const ConstraintBlock* block, const unsigned row) : B(block), r(row) {}
+		inline ConstraintRow operator*() const { return ConstraintRow(B, r); }
+		inline const_iterator& operator++() { ++r; return *this; }
+		inline bool operator!=(const const_iterator& it) const { return r != it.r; }
+	};
+
+	ConstraintBlock() { clear(); }
+	explicit ConstraintBlock(const std::vector<ConstraintExpression>& cons) { assign(cons); }
+
+	/**
+	 * Remove all rows
+	 */
+	inline void clear() {
+		sense.clear(); rhs.clear(); hasX.clear(); hasQ.clear(); hasXQ.clear();
+		xBeg.assign(1, 0); xInd.clear(); xVal.clear();
+		qBeg.assign(1, 0); qInd.clear(); qVal.clear();
+		xqBeg.assign(1, 0); xqX.clear(); xqQ.clear(); xqVal.clear();
+		xGrpBeg.assign(1, 0); xGrpQ.clear(); xGrpVal.clear();
+		qGrpBeg.assign(1, 0); qGrpX.clear(); qGrpVal.clear();
+	}
+
+	/**
+	 * Append a constraint
+	 * @param con constraint to be appended
+	 */
+	inline void push_back(const ConstraintExpression& con) {
+		sense.push_back(con.sense);
+		rhs.push_back(con.rhs);
+		hasX.push_back(!con.isEmpty());
+		hasQ.push_back(con.existConstQTerms());
+		hasXQ.push_back(con.existBilinearTerms());
+
+		xInd.insert(xInd.end(), con.varIndices.begin(), con.varIndices.end());
+		xVal.insert(xVal.end(), con.varCoeffs.begin(), con.varCoeffs.end());
+		xBeg.push_back(xInd.size());
+
+		qInd.insert(qInd.end(), con.paramIndices.begin(), con.paramIndices.end());
+		qVal.insert(qVal.end(), con.paramCoeffs.begin(), con.paramCoeffs.end());
+		qBeg.push_back(qInd.size());
+
+		for (unsigned k = 0; k < con.bilinearIndices.size(); ++k) {
+			xqX.push_back(con.bilinearIndices[k].first);
+			xqQ.push_back(con.bilinearIndices[k].second);
+		}
+		xqVal.insert(xqVal.end(), con.bilinearCoeffs.begin(), con.bilinearCoeffs.end());
+		xqBeg.push_back(xqVal.size());
+
+		// group the nonzero xq-terms by x-term and by q-term (in their original order)
+		for (unsigned i = 0; i < con.varIndices.size(); ++i) {
+			for (unsigned k = 0; k < con.bilinearIndices.size(); ++k) if (con.bilinearIndices[k].first == con.varIndices[i]) {
+				if (con.bilinearCoeffs[k] != 0.0) {
+					xGrpQ.push_back(con.bilinearIndices[k].second);
+					xGrpVal.push_back(con.bilinearCoeffs[k]);
+				}
+			}
+			xGrpBeg.push_back(xGrpQ.size());
+		}
+		for (unsigned i = 0; i < con.paramIndices.size(); ++i) {
+			for (unsigned k = 0; k < con.bilinearIndices.size(); ++k) if (con.bilinearIndices[k].second == con.paramIndices[i]) {
+				if (con.bilinearCoeffs[k] != 0.0) {
+					qGrpX.push_back(con.bilinearIndices[k].first);
+					qGrpVal.push_back(con.bilinearCoeffs[k]);
+				}
+			}
+			qGrpBeg.push_back(qGrpX.size());
+		}
+	}
+
+	/**
+	 * Replace the contents of the block
+	 * @param cons constraints to be stored
+	 */
+	inline void assign(const std::vector<ConstraintExpression>& cons) {
+		clear();
+		for (const auto& con : cons) push_back(con);
+		shrink_to_fit();
+	}
+
+	/**
+	 * Release unused capacity
+	 */
+	inline void shrink_to_fit() {
+		sense.shrink_to_fit(); rhs.shrink_to_fit(); hasX.shrink_to_fit(); hasQ.shrink_to_fit(); hasXQ.shrink_to_fit();
+		xBeg.shrink_to_fit(); xInd.shrink_to_fit(); xVal.shrink_to_fit();
+		qBeg.shrink_to_fit(); qInd.shrink_to_fit(); qVal.shrink_to_fit();
+		xqBeg.shrink_to_fit(); xqX.shrink_to_fit(); xqQ.shrink_to_fit(); xqVal.shrink_to_fit();
+		xGrpBeg.shrink_to_fit(); xGrpQ.shrink_to_fit(); xGrpVal.shrink_to_fit();
+		qGrpBeg.shrink_to_fit(); qGrpX.shrink_to_fit(); qGrpVal.shrink_to_fit();
+	}
+
+	inline unsigned size() const { return sense.size(); }
+	inline bool empty() const { return sense.empty(); }
+	inline ConstraintRow operator[](const unsigned r) const { assert(r < size()); return ConstraintRow(this, r); }
+	inline const_iterator begin() const { return const_iterator(this, 0); }
+	inline const_iterator end() const { return const_iterator(this, size()); }
+};
+
+//-----------------------------------------------------------------------------------
+
+inline char ConstraintRow::getSense() const { return B->sense[r]; }
+
+inline double ConstraintRow::getRHS() const { return B->rhs[r]; }
+
+inline double ConstraintRow::getViolation(const std::vector<double>& varValues, const std::vector<double>& paramValues, const bool normalized) const {
+	const char sense = B->sense[r];
+	const double rhs = B->rhs[r];
+	const bool xTerms          = B->hasX[r];
+	const bool qTermsConst     = B->hasQ[r];
+	const bool qTermsInProduct = B->hasXQ[r];
+
+	// same as ConstraintExpression::getViolation_fixedXQ()
+	if (sense == 'E') {
+		double viol = 0;
+		if (xTerms) if (varValues.empty()) {
+			std::cerr << "Error: getViolation() requires values for primal variables\n";
+			return 1.0;
+		}
+		if (qTermsInProduct || qTermsConst) if (paramValues.empty()) {
+			std::cerr << "Error: getViolation() requires values for uncertain parameters\n";
+			return 1.0;
+		}
+
+		double f = (normalized ? 0.0 : 1.0);
+		viol += -rhs;
+		if (qTermsConst) for (unsigned k = B->qBeg[r]; k < B->qBeg[r + 1]; k++) {
+			viol += B->qVal[k] * paramValues.at(B->qInd[k]);
+			if (normalized) f += B->qVal[k] * B->qVal[k];
+		}
+		if (xTerms) for (unsigned k = B->xBeg[r]; k < B->xBeg[r + 1]; k++) {
+			viol += B->xVal[k] * varValues.at(B->xInd[k]);
+		}
+		if (qTermsInProduct) for (unsigned k = B->xqBeg[r]; k < B->xqBeg[r + 1]; k++) {
+			viol += B->xqVal[k] * varValues.at(B->xqX[k]) * paramValues.at(B->xqQ[k]);
+			if (normalized) f += B->xqVal[k] * varValues.at(B->xqX[k]) * B->xqVal[k] * varValues.at(B->xqX[k]);
+		}
+		if (normalized) {
+			assert(f != 0.0);
+			viol /= std::sqrt(f);
+		}
+		if (viol < 0) viol *= -1.0;
+		return viol;
+	}
+
+	// same as ConstraintExpression::getViolation_LE()
+	const double f = (sense == 'G') ? (-1.0) : (+1.0);
+
+	if(qTermsInProduct || qTermsConst) if(paramValues.empty()) { std::cerr << " Error: Parameter values not supplied for evaluation of K-adaptable expression. \n"; exit(-1); }
+	if(xTerms)                         if(varValues.empty())   { std::cerr << " Error: Primal variable values not supplied for evaluation of K-adaptable expression. \n"; exit(-1); }
+
+	double eval = 0.0, Normalization = (normalized ? 0.0 : 1.0);
+
+	eval += -(f * rhs);
+
+	if (qTermsConst) for (unsigned k = B->qBeg[r]; k < B->qBeg[r + 1]; k++) {
+		const double t = f * B->qVal[k];
+		eval += t * paramValues.at(B->qInd[k]);
+		if (normalized) Normalization += t * t;
+	}
+
+	if (xTerms) for (unsigned k = B->xBeg[r]; k < B->xBeg[r + 1]; k++) {
+		eval += (f * B->xVal[k])*varValues.at(B->xInd[k]);
+	}
+
+	if (qTermsInProduct) for (unsigned k = B->xqBeg[r]; k < B->xqBeg[r + 1]; k++) {
+		const double t = (f * B->xqVal[k])*varValues.at(B->xqX[k]);
+		eval += t * paramValues.at(B->xqQ[k]);
+		if (normalized) Normalization += t * t;
+	}
+
+	if (normalized) {
+		assert(Normalization != 0.0);
+		eval /= std::sqrt(Normalization);
+	}
+
+	return eval;
+}
+
+inline CPXNNZ ConstraintRow::appendDeterministicConstraint(const std::vector<double>& paramValues, double& trueRhs, char& trueSense, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const {
+	trueSense = B->sense[r];
+
+	/* rhs - bq */
+	trueRhs = B->rhs[r];
+	for (unsigned k = B->qBeg[r]; k < B->qBeg[r + 1]; k++)
+		if (B->qVal[k] != 0.0)
+			trueRhs -= (B->qVal[k]*paramValues.at(B->qInd[k]));
+
+	/* c + Sq */
+	CPXNNZ nzcnt = 0;
+	for (unsigned k = B->xBeg[r]; k < B->xBeg[r + 1]; k++) {
+		bool inExpr = 0;
+		double coef = 0.0;
+		if (B->xVal[k] != 0.0) {
+			coef += B->xVal[k];
+			inExpr = 1;
+		}
+		for (unsigned g = B->xGrpBeg[k]; g < B->xGrpBeg[k + 1]; g++) {
+			coef += paramValues.at(B->xGrpQ[g])*B->xGrpVal[g];
+			inExpr = 1;
+		}
+		if (inExpr) {
+			nzcnt++;
+			rmatind.emplace_back(B->xInd[k]);
+			rmatval.emplace_back(coef);
+		}
+	}
+
+	return nzcnt;
+}
+
+inline CPXNNZ ConstraintRow::appendStochasticConstraint(const std::vector<double>& varValues, double& trueRhs, char& trueSense, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const {
+	trueSense = B->sense[r];
+
+	/* rhs - cx */
+	trueRhs = B->rhs[r];
+	for (unsigned k = B->xBeg[r]; k < B->xBeg[r + 1]; k++)
+		if (B->xVal[k] != 0.0)
+			trueRhs -= (B->xVal[k]*varValues.at(B->xInd[k]));
+
+	/* b + xS */
+	CPXNNZ nzcnt = 0;
+	for (unsigned k = B->qBeg[r]; k < B->qBeg[r + 1]; k++) {
+		bool inExpr = 0;
+		double coef = 0.0;
+		if (B->qVal[k] != 0.0) {
+			coef += B->qVal[k];
+			inExpr = 1;
+		}
+		for (unsigned g = B->qGrpBeg[k]; g < B->qGrpBeg[k + 1]; g++) {
+			coef += varValues.at(B->qGrpX[g])*B->qGrpVal[g];
+			inExpr = 1;
+		}
+		if (inExpr) {
+			nzcnt++;
+			rmatind.emplace_back(B->qInd[k]);
+			rmatval.emplace_back(coef);
+		}
+	}
+
+	return nzcnt;
+}
+
+#endif
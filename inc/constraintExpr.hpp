@@ -24,6 +24,7 @@
 #include <iostream>
 #include <ilcplex/cplexx.h>
 #include "uncertainty.hpp"
+#include "modelNames.hpp"
 
 
 #define CONSTRAINT_EXPRESSION_OUTPUTLEVEL 0
@@ -52,6 +53,7 @@ typedef std::vector<pair_t> pairIndices_t;
  *---------------------------------------------------------*/
 class ConstraintExpression {
 	friend class KAdaptableExpression;
+	friend class ConstraintBlock;
 private:
 	char sense;/* Default: 'L', i.e., <= */
 	double rhs;/* Default: 0 */
@@ -132,6 +134,18 @@ public:
 	inline void rowname(const std::string& argName) { name = argName; return; }
 	inline void addTermX(const int ind, const double val) { addTerm(ind, val, varIndices, varCoeffs); return; }
 	inline void addTermQ(const int ind, const double val) { addTerm(ind, val, paramIndices, paramCoeffs); return; }
+	/**
+	 * Release the capacity reserved for terms that were not added (see reserve())
+	 */
+	inline void shrink_to_fit() {
+		varIndices.shrink_to_fit();
+		varCoeffs.shrink_to_fit();
+		paramIndices.shrink_to_fit();
+		paramCoeffs.shrink_to_fit();
+		bilinearIndices.shrink_to_fit();
+		bilinearCoeffs.shrink_to_fit();
+		return;
+	}
     inline void addConst(const double cst) {rhs -= cst; return;}
     inline ConstraintExpression projectToW(const std::vector<int> indices, int beginW) const{
         ConstraintExpression N;
@@ -463,7 +477,7 @@ public:
 		if (deterministic) {
 			char trueSense = sense;
 			const CPXNNZ rmatbeg = 0;
-			const char *rowname = name.c_str();
+			const char *rowname = name.empty() ? nullptr : name.c_str();
 
 			/* Compute right-hand-size as supplied rhs - bq */
 			double trueRhs = rhs;
@@ -504,7 +518,7 @@ public:
 			assert((CPXNNZ)rmatind.size() == nzcnt);
 			assert(rmatval.size() == rmatind.size());
 
-			return CPXXaddrows(env, lp, 0, 1, nzcnt, &trueRhs, &trueSense, &rmatbeg, &rmatind[0], &rmatval[0], nullptr, &rowname);
+			return CPXXaddrows(env, lp, 0, 1, nzcnt, &trueRhs, &trueSense, &rmatbeg, &rmatind[0], &rmatval[0], nullptr, rowname ? &rowname : nullptr);
 		}
 		//=====================================================================
 		/* DUALIZE CONSTRAINT BEFORE ADDING BACK TO THE (REFORMULATED) MODEL */
@@ -564,13 +578,16 @@ public:
 
 			/* UncSet: W*q + V*Ksee [sense] h */
 			/* Depending on sense [>=, <=, =], the dual variables have appropriate signs and bounds */
-			const auto W = UncSet->getMatrixW();
-			const auto V = UncSet->getMatrixV();
 			const auto h = UncSet->getMatrixH();
-			assert(W.size() == h.size());
-			assert(V.size() == h.size());
 			assert(r + 1 == (int)h.size());
 
+			/* Columns of W in sparse form: Wcol[l] = {(s, W(s,l)) : W(s,l) != 0} */
+			std::vector<std::vector<std::pair<int, double> > > Wcol(1 + UncSet->getNoOfUncertainParameters());
+			for (int s = 1; s <= r; s++) {
+				const auto row = UncSet->getRowW(s);
+				for (int k = 0; k < row.nnz; k++) Wcol[row.ind[k]].emplace_back(s, row.val[k]);
+			}
+
 			/* Last variable index of the original model
 			 * before new variables were created
 			 */
@@ -585,7 +602,7 @@ public:
 
 
 			/* Add the constraint corresponding to the objective of the inner maximization problem */
-			ConstraintExpression ReformObjExpr("DualObj(" + name + ")", sense, rhs);
+			ConstraintExpression ReformObjExpr(modelName("DualObj", name), sense, rhs);
 
 			/* Terms involving only x (e.g., cx) carry over as-is */
 			for (unsigned i = 0; i < varIndices.size(); ++i) if(varCoeffs[i] != 0.0) ReformObjExpr.addTermX(varIndices[i], varCoeffs[i]);
@@ -626,7 +643,7 @@ public:
 				if (sense == 'G') dualConstraintRhs *= (-1.0);
 				
 				/* Constraint of dual problem corresponding to this column of the uncertainty set */
-				ConstraintExpression ReformConstrExpr("DualCon(" + name + "," + std::to_string(l) + ")");
+				ConstraintExpression ReformConstrExpr(modelName("DualCon", name, l));
 				ReformConstrExpr.sign('E');
 				ReformConstrExpr.RHS(dualConstraintRhs);
 
@@ -640,9 +657,9 @@ public:
 				/* Add nonzeros corresponding to constraints of the uncertainty set */
 				/* Only add those coefficients which are true non-zeros */
 				/* SUM[s = 1 to r, W(s,l)Ksee(s)] */
-				for (int s = 1; s <= r; s++) if (W.at(s).at(l) != 0.0) {
-					const int dualVarIndex = lastIndBeforeDual + s;
-					ReformConstrExpr.addTermX(dualVarIndex, W.at(s).at(l));
+				for (const auto& w : Wcol.at(l)) {
+					const int dualVarIndex = lastIndBeforeDual + w.first;
+					ReformConstrExpr.addTermX(dualVarIndex, w.second);
 				}
 
 				/* Add constraint */
@@ -658,6 +675,8 @@ public:
 			/* If using factor models, then we need an additional constraint
 			 * Note that for any other uncertainty set, V = 0 and we'll end up adding no new constraints
 			 */
+			std::vector<std::vector<double> > V;
+			if (UncSet->getNumBudgetsFactors() > 0) V = UncSet->getMatrixV();
 			for (int f = 1; f <= UncSet->getNumBudgetsFactors(); f++) {
 				bool nonzero = 0;
 				for (int s = 1; s <= r; s++) if (V.at(s).at(f) != 0.0) { nonzero = 1; break; }
@@ -665,7 +684,7 @@ public:
 				
 				/* Attempt to add the constraint only if at least one non-zero exists */
 				if (nonzero) {
-					ConstraintExpression ReformFactorExpr("DualConFactor(" + name + ",F" + std::to_string(f) + ")", 'E', 0);
+					ConstraintExpression ReformFactorExpr(modelName("DualConFactor", name, NAME_MODEL_ELEMENTS ? "F" + std::to_string(f) : std::string()), 'E', 0);
 					for (int s = 1; s <= r; s++) if (V.at(s).at(f) != 0.0) {
 						const int dualVarIndex = lastIndBeforeDual + s;
 						ReformFactorExpr.addTermX(dualVarIndex, V.at(s).at(f));
@@ -685,6 +704,112 @@ public:
 	inline char getSense() const { return sense; }
 	inline double getRHS() const { return rhs; }
 	inline std::string getName() const { return name; }
+
+	/*------------------------------------------
+	 | Value of (cx + bq + xSq - d)/||b + xS|| at fixed (x, q), in <= form (i.e., negated for 'G').
+	 | Performs the same floating-point operations as KAdaptableExpression::evaluate() on this
+	 | constraint alone, but without copying it.
+	 *------------------------------------------*/
+	inline double getViolation_LE(const std::vector<double>& varValues,
+	                              const std::vector<double>& paramValues,
+	                              const bool normalized = 0) const
+	{
+		assert(sense != 'E');
+		const double f = (sense == 'G') ? (-1.0) : (+1.0);
+
+		const bool qTermsInProduct = existBilinearTerms();
+		const bool qTermsConst     = existConstQTerms();
+		const bool xTermsConst     = !isEmpty();
+
+		if(qTermsInProduct || qTermsConst) if(paramValues.empty()) { std::cerr << " Error: Parameter values not supplied for evaluation of K-adaptable expression. \n"; exit(-1); }
+		if(xTermsConst)                    if(varValues.empty())   { std::cerr << " Error: Primal variable values not supplied for evaluation of K-adaptable expression. \n"; exit(-1); }
+
+		double eval = 0.0, Normalization = (normalized ? 0.0 : 1.0);
+
+		/* -d */
+		eval += -(f * rhs);
+
+		/* +bq* */
+		if(qTermsConst)
+			for(size_t i=0; i<paramCoeffs.size(); i++) {
+				const double t = f * paramCoeffs[i];
+				eval += t * paramValues.at(paramIndices.at(i));
+				if (normalized) Normalization += t * t;
+			}
+
+		/* +cx* */
+		if(xTermsConst)
+			for(size_t i=0; i<varCoeffs.size(); i++)
+				eval += (f * varCoeffs[i])*varValues.at(varIndices.at(i));
+
+		/* +x*Sq* */
+		if(qTermsInProduct)
+			for(size_t i=0; i<bilinearCoeffs.size(); i++) {
+				const double t = (f * bilinearCoeffs[i])*varValues.at(bilinearIndices.at(i).first);
+				eval += t * paramValues.at(bilinearIndices.at(i).second);
+				if (normalized) Normalization += t * t;
+			}
+
+		if (normalized) {
+			assert(Normalization != 0.0);
+			eval /= std::sqrt(Normalization);
+		}
+
+		return eval;
+	}
+
+	/*------------------------------------------
+	 | Row  ||b + xS|| tau - bq - xSq <= -d + cx  of the separation problem over q for fixed x,
+	 | in <= form (i.e., negated for 'G'); column 0 is tau. Bilinear terms are kept in the
+	 | pattern even if x is zero, so that the pattern does not depend on x.
+	 | ind, val are overwritten; coef must be a zero vector of size 1 + N (it is zero on return).
+	 *------------------------------------------*/
+	inline void getSeparationRow(const std::vector<double>& varValues,
+	                             const bool normalized,
+	                             const bool xTermsConst,
+	                             const bool qTermsInProduct,
+	                             std::vector<int>& ind,
+	                             std::vector<double>& val,
+	                             double& rowRhs,
+	                             std::vector<double>& coef) const
+	{
+		assert(sense != 'E');
+		const double f = (sense == 'G') ? (-1.0) : (+1.0);
+
+		ind.clear();
+		val.clear();
+
+		/* -d + cx */
+		rowRhs = -(f * rhs); if (xTermsConst) for (size_t i = 0; i < varCoeffs.size(); i++) rowRhs += (f * varCoeffs[i]) * varValues.at(varIndices.at(i));
+
+		/* Normalized value --> quantity dividing the {...} term in max_q min_p {...} */
+		double Normalization = (normalized ? 0.0 : 1.0);
+
+		/* -bq */
+		for (size_t i = 0; i < paramCoeffs.size(); i++) if (paramCoeffs[i] != 0.0) {
+			const double b = f * paramCoeffs[i];
+			ind.push_back(paramIndices[i]);
+			coef.at(paramIndices[i]) -= b;
+			if (normalized) Normalization += b * b;
+		}
+
+		/* -x*Sq */
+		if (qTermsInProduct) for (size_t i = 0; i < bilinearCoeffs.size(); i++) if (bilinearCoeffs[i] != 0.0) {
+			const double t = ((f * bilinearCoeffs[i]) * varValues.at(bilinearIndices[i].first));
+			ind.push_back(bilinearIndices[i].second);
+			coef.at(bilinearIndices[i].second) -= t;
+			if (normalized) Normalization += t * t;
+		}
+
+		/* \tau */
+		std::sort(ind.begin(), ind.end());
+		ind.erase(std::unique(ind.begin(), ind.end()), ind.end());
+		ind.insert(ind.begin(), 0);
+		coef[0] = std::sqrt(Normalization);
+
+		for (const auto& j : ind) { val.push_back(coef[j]); coef[j] = 0.0; }
+	}
+
 	inline double getViolation_fixedXQ(const std::vector<double>& varValues,
 	                                   const std::vector<double>& paramValues = {},
 	                                   const bool normalized = 0) const
@@ -788,6 +913,23 @@ public:
 		assert(N.isConsistentWithDesign());
 		return N;
 	}
+	/* Copy of this constraint in which the variables with index >= first are shifted by offset
+	 * (e.g., policy k of a 2nd-stage constraint from policy 0) */
+	inline ConstraintExpression shiftVars(const int first, const int offset, const std::string& suffix = "") const {
+		ConstraintExpression N;
+		N.sense = sense;
+		N.rhs = rhs;
+		N.name = modelNameSuffix(name, suffix.c_str());
+		N.varIndices = varIndices;
+		N.varCoeffs = varCoeffs;
+		N.bilinearIndices = bilinearIndices;
+		N.bilinearCoeffs = bilinearCoeffs;
+		N.paramIndices = paramIndices;
+		N.paramCoeffs = paramCoeffs;
+		for (auto& i : N.varIndices) if (i >= first) i += offset;
+		for (auto& xq : N.bilinearIndices) if (xq.first >= first) xq.first += offset;
+		return N;
+	}
     inline ConstraintExpression mapParamK(const unsigned int k, int numParam) const {
         ConstraintExpression N;
         
@@ -970,92 +1112,30 @@ public:
 			
 			
 			
-			int stat;
-
-			/* Get ENV object from Uncertainty Set */
-			CPXENVptr env = UncSet->getENVObject();
-			
-			/* Clone LP object from Uncertainty Set */
-			CPXLPptr lp = UncSet->getLPObject(&stat);
-			if (stat) {std::cerr << "Failed to clone CPLEX LP object inside evaluation of K-adaptable expression. \n"; exit(-1);}
-
-			
-			int ind = 0; double coef = 1; char lb = 'L'; char ub = 'U'; double lbVal = -CPX_INFBOUND; double ubVal = +CPX_INFBOUND;
-
-			/* Make it a maximization problem */
-			CPXXchgobjsen(env, lp, CPX_MAX);
-			/* Make it an LP */
-			CPXXchgprobtype(env, lp, CPXPROB_LP);
-			/* Replace current objective function */
-			CPXXchgobj(env, lp, 1, &ind, &coef); coef = 0; for (int l = 1; l <= UncSet->getNoOfUncertainParameters(); ++l) CPXXchgobj(env, lp, 1, &l, &coef);
-			/* Change bounds on objective function variable to make it (-Inf, +Inf) */
-			CPXXchgbds(env, lp, 1, &ind, &lb, &lbVal);
-            
-            stat = CPXXchgbds(env, lp, 1, &ind, &ub, &ubVal);
-            if (stat) {std::cerr << "Failed to change objective inside evaluation of K-adaptable expression. \n"; exit(-1);}
-            
-//            std::vector<double> lbget(5, 0);
-//            assert(!CPXXgetlb(env, lp, &lbget[0], 0, 4));
-
-			/* Add constraints corresponding to each of the P constraints in Expr */
-			for(const auto& exp: Expr) {
-				ConstraintExpression TauConstr("TauCon(" + exp.name + ")");
-
-				/* -d(p) + cx*(p) */
-				double this_rhs = -exp.rhs; if (xTermsConst) for (size_t i = 0; i < exp.varCoeffs.size(); i++) this_rhs += exp.varCoeffs[i] * varValues.at(exp.varIndices.at(i));
-
-				TauConstr.sign('L');
-				TauConstr.RHS(this_rhs);
-
-				/* Normalized value --> quantity dividing the {...} term in max_q min_p {...} */
-				double Normalization = (normalized ? 0.0 : 1.0);
-
-				/* -bq */
-				for (size_t i = 0; i < exp.paramCoeffs.size(); i++) if (exp.paramCoeffs[i] != 0.0) {
-					TauConstr.addTermX( exp.paramIndices[i], -exp.paramCoeffs[i]);
-					if (normalized) Normalization += exp.paramCoeffs[i] * exp.paramCoeffs[i];
-				}
-
-				/* -x*Sq */
-				if (qTermsInProduct) for (size_t i = 0; i < exp.bilinearCoeffs.size(); i++) if (exp.bilinearCoeffs[i] != 0.0) if (varValues.at(exp.bilinearIndices[i].first) != 0.0) {
-					const double t = (exp.bilinearCoeffs[i] * varValues.at(exp.bilinearIndices[i].first));
-					TauConstr.addTermX( exp.bilinearIndices[i].second, -t );
-					if (normalized) Normalization += t * t;
-				}
-
-				/* \tau */
-				TauConstr.addTermX(0, std::sqrt(Normalization));
-                
-				stat = TauConstr.addToCplex(env, lp);
-                
-                if (stat) {std::cerr << "Failed to add constraint to CPLEX inside evaluation of K-adaptable expression. \n"; exit(-1);}
-                
+			const int N = UncSet->getNoOfUncertainParameters();
+
+			/* Rows tau*||.|| - bq - x*Sq <= -d + cx, one for each of the P constraints in Expr.
+			 * Bilinear terms are kept in the pattern even if x is zero, so that the row pattern
+			 * (and hence the persistent separation LP of the uncertainty set) does not depend on x. */
+			std::vector<std::vector<int> > rowInd(Expr.size());
+			std::vector<std::vector<double> > rowVal(Expr.size());
+			std::vector<double> rowRhs(Expr.size(), 0.0);
+			std::vector<double> coef(1 + N, 0.0);
+
+			for (size_t p = 0; p < Expr.size(); p++) {
+				Expr[p].getSeparationRow(varValues, normalized, xTermsConst, qTermsInProduct, rowInd[p], rowVal[p], rowRhs[p], coef);
 			}
-            // CPXXwriteprob(env, lp, "/Users/lynn/Desktop/research/DRO/BnB/model_output/bbunc", "LP");
-			/* Solve LP */
-			stat = CPXXlpopt(env, lp);
-			if (stat) std::cerr << "Could not solve LP inside evaluation of K-adaptable expression.\n";
 
+			/* Solve LP */
+			std::vector<double> primalX;
+			const int lpstat = UncSet->solveSeparationLP(rowInd, rowVal, rowRhs, primalX);
 
 			/* Assert that LP was solved to optimality */
-			if (CPXXgetstat(env, lp) != CPX_STAT_OPTIMAL) {
-				std::cerr << "\n\n Could not solve LP to optimality inside the evaluation problem of K-adaptable expression." << CPXXgetstat(env, lp) << "\n\n";
+			if (lpstat != CPX_STAT_OPTIMAL) {
+				std::cerr << "\n\n Could not solve LP to optimality inside the evaluation problem of K-adaptable expression." << lpstat << "\n\n";
 				exit(-2);
 			}
 
-			/* Get optimal RHS value */
-			double objval; CPXXgetobjval(env, lp, &objval);
-
-			/* Get primal solution vector */
-			std::vector<double> primalX(1 + UncSet->getNoOfUncertainParameters(), objval); CPXXgetx(env, lp, &primalX[1], UncSet->getParamIndex('q', 1), UncSet->getParamIndex('q', UncSet->getNoOfUncertainParameters()));
-
-			/* Free memory */
-			if (lp != nullptr) {
-				stat = CPXXfreeprob(env, &lp);
-				if (stat) std::cerr << "CPXfreeprob failed inside K-adaptable expression, error code " << stat << "\n";
-			}
-
-
 			return primalX;
 		}
 	}
@@ -1077,30 +1157,44 @@ static inline double getViolation(const ConstraintExpression& con,
 		return con.getViolation_fixedXQ(varValues, paramValues, normalized);
 	}
 
-	// Construct K-adaptable expression with single policy
-	std::vector<ConstraintExpression> exp{con};
-	KAdaptableExpression CExpr(exp, con.getName());
-
-	// evaluate worst-case value
-	const auto q = CExpr.evaluate(nullptr, paramValues, varValues, normalized);
-	assert(!q.empty());
-
-	return q[0];
+	// same as evaluating the single-policy K-adaptable expression, without copying the constraint
+	return con.getViolation_LE(varValues, paramValues, normalized);
 }
 
-static inline std::vector<double> getViolation(const ConstraintExpression& con,
-                                               UNCSetCPtr UncSet,
-                                               const std::vector<double>& varValues = {},
-                                               const bool normalized = 0)
+static inline void getViolation(const ConstraintExpression& con,
+                                UNCSetCPtr UncSet,
+                                const std::vector<double>& varValues,
+                                std::vector<double>& q,
+                                const bool normalized = 0)
 {
+	// fast path: single separation row built in reusable buffers (same result as the general path below)
+	const bool qTermsInProduct = con.existBilinearTerms();
+	const bool xTermsConst     = !con.isEmpty();
+	if (UncSet != nullptr && UncSet->isUncertain() && con.getSense() != 'E' && (qTermsInProduct || con.existConstQTerms()) && !((qTermsInProduct || xTermsConst) && varValues.empty())) {
+		static thread_local std::vector<std::vector<int> > rowInd(1);
+		static thread_local std::vector<std::vector<double> > rowVal(1);
+		static thread_local std::vector<double> rowRhs(1);
+		static thread_local std::vector<double> coef;
+		coef.assign(1 + UncSet->getNoOfUncertainParameters(), 0.0);
+
+		con.getSeparationRow(varValues, normalized, xTermsConst, qTermsInProduct, rowInd[0], rowVal[0], rowRhs[0], coef);
+
+		const int lpstat = UncSet->solveSeparationLP(rowInd, rowVal, rowRhs, q);
+		if (lpstat != CPX_STAT_OPTIMAL) {
+			std::cerr << "\n\n Could not solve LP to optimality inside the evaluation problem of K-adaptable expression." << lpstat << "\n\n";
+			exit(-2);
+		}
+		return;
+	}
+
 	// temporary var
 	std::vector<double> paramValues;
 
 	if (UncSet == nullptr && con.getSense() == 'E') {
 		const double viol = con.getViolation_fixedXQ(varValues, paramValues, normalized);
-		std::vector<double> q{viol};
+		q.assign(1, viol);
 		q.insert(q.end(), paramValues.begin(), paramValues.end());
-		return q;
+		return;
 	}
 
 	// Construct K-adaptable expression with single policy
@@ -1108,9 +1202,17 @@ static inline std::vector<double> getViolation(const ConstraintExpression& con,
 	KAdaptableExpression CExpr(exp, con.getName());
 
 	// evaluate worst-case value
-	const auto q = CExpr.evaluate(UncSet, paramValues, varValues, normalized);
+	q = CExpr.evaluate(UncSet, paramValues, varValues, normalized);
 	assert((int)q.size() == 1 + UncSet->getNoOfUncertainParameters());
+}
 
+static inline std::vector<double> getViolation(const ConstraintExpression& con,
+                                               UNCSetCPtr UncSet,
+                                               const std::vector<double>& varValues = {},
+                                               const bool normalized = 0)
+{
+	std::vector<double> q;
+	getViolation(con, UncSet, varValues, q, normalized);
 	return q;
 }
 
@@ -0,0 +1,212 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+#ifndef CUTPOOL_HPP
+#define CUTPOOL_HPP
+
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+/**
+ * Pool of cuts generated in the cutting-plane callbacks.
+ *
+ * Cuts are grouped by (policy, scenario label) and identified within a group by the
+ * id of the constraint they were generated from. Coefficients are normalized by their
+ * largest absolute value so that the same cut regenerated at a different node is
+ * stored only once. Each cut keeps track of how often it was found violated, so that
+ * cuts that have not been useful for a while can be purged.
+ */
+class CutPool {
+public:
+    /** A single pooled cut: sum_i val[i] * x[ind[i]] (sense) rhs */
+    struct Cut {
+        int label;
+        int cstr;
+        std::vector<int> ind;
+        std::vector<double> val;
+        double rhs;
+        char sense;
+
+        /** Scenario from which the cut was generated (empty if not recorded) */
+        std::vector<double> scenario;
+
+        /** # of times this cut was returned by findViolated() */
+        unsigned long numUsed;
+
+        /** Round in which this cut was last added or returned */
+        unsigned long lastUsed;
+    };
+
+private:
+    /** Hash of the (policy, scenario label) key */
+    struct KeyHash {
+        std::size_t operator()(const std::pair<int, int>& key) const {
+            return std::hash<long long>()(((long long)key.first << 32) ^ (unsigned int)key.second);
+        }
+    };
+
+    /** [(k, l)] = cuts of policy k generated from scenario label l */
+    std::unordered_map<std::pair<int, int>, std::vector<Cut>, KeyHash> cuts;
+
+    /** Current round (incremented by the caller, typically once per callback invocation) */
+    unsigned long round = 0;
+
+public:
+    /** Statistics */
+    unsigned long numAdded = 0, numDuplicates = 0, numReused = 0, numPurged = 0;
+
+    /**
+     * Remove all cuts and reset statistics
+     */
+    inline void clear() {
+        cuts.clear();
+        round = 0;
+        numAdded = numDuplicates = numReused = numPurged = 0;
+    }
+
+    /**
+     * Start a new round
+     * @return the new round number
+     */
+    inline unsigned long nextRound() {
+        return ++round;
+    }
+
+    /**
+     * Add a cut to the pool (after normalization), unless it is already stored
+     * @param  k     policy number
+     * @param  l     scenario label
+     * @param  cstr  id of the constraint from which the cut was generated
+     * @param  rhs   right-hand side
+     * @param  sense sense ('L', 'G' or 'E')
+     * @param  ind   column indices
+     * @param  val   coefficients
+     * @param  q     scenario from which the cut was generated (optional)
+     * @return       true if the cut was new
+     */
+    inline bool add(const int k, const int l, const int cstr, double rhs, const char sense, const std::vector<int>& ind, std::vector<double> val, const std::vector<double>& q = std::vector<double>()) {
+        assert(ind.size() == val.size());
+
+        // normalize
+        double scale = 0;
+        for (const auto& v : val) scale = std::max(scale, std::abs(v));
+        if (scale > 0) {
+            for (auto& v : val) v /= scale;
+            rhs /= scale;
+        }
+
+        // check for duplicates
+        auto& group = cuts[std::make_pair(k, l)];
+        for (auto& c : group) {
+            if (c.cstr != cstr || c.sense != sense || c.ind != ind) continue;
+            if (std::abs(c.rhs - rhs) > 1.E-9) continue;
+            bool same = true;
+            for (unsigned int i = 0; same && i < val.size(); i++) same = (std::abs(c.val[i] - val[i]) <= 1.E-9);
+            if (same) {
+                c.lastUsed = round;
+                numDuplicates++;
+                return false;
+            }
+        }
+
+        group.push_back(Cut{l, cstr, ind, val, rhs, sense, q, 0, round});
+        numAdded++;
+        return true;
+    }
+
+    /**
+     * Find the most violated pooled cut of policy k among the given scenario labels
+     * @param  k      policy number
+     * @param  labels scenario labels to be considered
+     * @param  x      point to be separated
+     * @param  eps    violation tolerance
+     * @return        most violated cut (NULL if none is violated by more than eps)
+     */
+    inline const Cut* findViolated(const int k, const std::vector<int>& labels, const std::vector<double>& x, const double eps) {
+        Cut* best = NULL;
+        double maxViol = eps;
+        for (const auto& l : labels) {
+            auto it = cuts.find(std::make_pair(k, l));
+            if (it == cuts.end()) continue;
+            for (auto& c : it->second) {
+                double lhs = 0;
+                for (unsigned int i = 0; i < c.ind.size(); i++) lhs += c.val[i] * x[c.ind[i]];
+                double viol = (lhs - c.rhs) * ((c.sense == 'G') ? -1.0 : +1.0);
+                if (c.sense == 'E') viol = std::abs(lhs - c.rhs);
+                if (viol > maxViol) {
+                    maxViol = viol;
+                    best = &c;
+                }
+            }
+        }
+        if (best) {
+            best->numUsed++;
+            best->lastUsed = round;
+            numReused++;
+        }
+        return best;
+    }
+
+    /**
+     * Remove cuts that have not been added or found violated during the last few rounds
+     * @param age maximum # of rounds a cut may stay unused
+     */
+    inline void purge(const unsigned long age) {
+        for (auto it = cuts.begin(); it != cuts.end(); ) {
+            auto& group = it->second;
+            const auto size = group.size();
+            group.erase(std::remove_if(group.begin(), group.end(), [&](const Cut& c) {
+                return (c.lastUsed + age < round);
+            }), group.end());
+            numPurged += size - group.size();
+            if (group.empty()) it = cuts.erase(it);
+            else ++it;
+        }
+    }
+
+    /**
+     * Get the # of cuts currently stored
+     * @return # of pooled cuts
+     */
+    inline unsigned long size() const {
+        unsigned long n = 0;
+        for (const auto& group : cuts) n += group.second.size();
+        return n;
+    }
+};
+
+/**
+ * Gives a solve its own (empty) cut pool for the lifetime of this object. The pool of an
+ * enclosing solve, e.g., the one whose callback started this solve, is restored afterwards.
+ */
+class ScopedCutPool {
+private:
+    CutPool pool;
+    CutPool*& current;
+    CutPool* const outer;
+
+public:
+    /**
+     * @param slot pointer to the pool of the running solve (set to the new pool until destruction)
+     */
+    explicit ScopedCutPool(CutPool*& slot) : current(slot), outer(slot) { current = &pool; }
+    ~ScopedCutPool() { current = outer; }
+
+    ScopedCutPool(const ScopedCutPool&) = delete;
+    ScopedCutPool& operator=(const ScopedCutPool&) = delete;
+};
+
+#endif
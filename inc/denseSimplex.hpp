@@ -0,0 +1,427 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+#ifndef DENSESIMPLEX_HPP
+#define DENSESIMPLEX_HPP
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cassert>
+
+/**
+ * Bounded-variable primal simplex on a dense tableau, for small LPs of the form
+ *
+ *   max c'x  s.t.  a_r'x [<=, >=, =] b_r (r = 1..m),  lb <= x <= ub.
+ *
+ * Bounds whose absolute value is at least the given infinity are treated as infinite.
+ * Every row gets a slack variable; rows that are violated by the initial point get an
+ * artificial variable as well, whose sum is minimized in phase 1. The tableau B^{-1}[A I]
+ * is stored row-major in one contiguous array, so that a pivot is a sequence of axpy
+ * operations on contiguous rows (which the compiler vectorizes).
+ *
+ * The solution is checked against the original rows before it is reported as optimal;
+ * numerical trouble is reported as such, so that the caller can fall back to a
+ * general-purpose solver.
+ */
+class DenseSimplex {
+public:
+    /** Solution status */
+    enum Status { OPTIMAL, INFEASIBLE, UNBOUNDED, ITERATION_LIMIT, NUMERICAL_ERROR };
+
+private:
+    /** # of structural columns and rows */
+    int n = 0, m = 0;
+
+    /** Bounds at least this large (in absolute value) are infinite */
+    double infinity = 1.E20;
+
+    /** Objective, bounds (size n) */
+    std::vector<double> c, lb, ub;
+
+    /** Rows (m x n, row-major), senses and right-hand sides */
+    std::vector<double> A;
+    std::vector<char> sense;
+    std::vector<double> b;
+
+    /** Working data: tableau (m x width, row-major), reduced costs, costs of the current phase */
+    int width = 0;
+    std::vector<double> T, d, cost;
+
+    /** Working data: bounds and values of all variables (structural, slack, artificial) */
+    std::vector<double> lo, up, x;
+
+    /** Working data: basic variable of each row, row of each basic variable (-1 if nonbasic) */
+    std::vector<int> basis, pos;
+
+    /** Working data: row and coefficient of each artificial variable */
+    std::vector<int> artRow;
+    std::vector<double> artSign;
+
+    /** Statistics */
+    long iterations = 0;
+
+    /** Optimal objective value */
+    double objval = 0;
+
+    /** Tolerances */
+    static constexpr double FEAS_TOL  = 1.E-9;
+    static constexpr double OPT_TOL   = 1.E-9;
+    static constexpr double PIVOT_TOL = 1.E-9;
+    static constexpr double CHECK_TOL = 1.E-6;
+
+    /** Pivot on element (r, q) of the tableau */
+    inline void pivot(const int r, const int q) {
+        double* const Tr = &T[(size_t)r * width];
+        const double inv = 1.0 / Tr[q];
+        for (int k = 0; k < width; k++) Tr[k] *= inv;
+        Tr[q] = 1.0;
+
+        for (int i = 0; i < m; i++) if (i != r) {
+            double* const Ti = &T[(size_t)i * width];
+            const double f = Ti[q];
+            if (f == 0.0) continue;
+            for (int k = 0; k < width; k++) Ti[k] -= f * Tr[k];
+            Ti[q] = 0.0;
+        }
+
+        const double f = d[q];
+        if (f != 0.0) for (int k = 0; k < width; k++) d[k] -= f * Tr[k];
+        d[q] = 0.0;
+
+        pos[basis[r]] = -1;
+        basis[r] = q;
+        pos[q] = r;
+    }
+
+    /** Reduced costs of the current basis with respect to cost */
+    inline void computeReducedCosts() {
+        d = cost;
+        for (int i = 0; i < m; i++) {
+            const double cb = cost[basis[i]];
+            if (cb == 0.0) continue;
+            const double* const Ti = &T[(size_t)i * width];
+            for (int k = 0; k < width; k++) d[k] -= cb * Ti[k];
+        }
+        for (int i = 0; i < m; i++) d[basis[i]] = 0.0;
+    }
+
+    /** Recompute the values of the basic variables from the nonbasic ones (removes drift) */
+    inline void computeBasicValues() {
+        std::vector<double> rhs(b);
+        for (int j = 0; j < width; j++) if (pos[j] < 0 && x[j] != 0.0) {
+            if (j < n) for (int i = 0; i < m; i++) rhs[i] -= A[(size_t)i * n + j] * x[j];
+            else if (j < n + m) rhs[j - n] -= x[j];
+            else rhs[artRow[j - n - m]] -= artSign[j - n - m] * x[j];
+        }
+        // B^{-1} is stored in the slack columns of the tableau
+        for (int i = 0; i < m; i++) {
+            const double* const Ti = &T[(size_t)i * width + n];
+            double v = 0;
+            for (int k = 0; k < m; k++) v += Ti[k] * rhs[k];
+            x[basis[i]] = v;
+        }
+    }
+
+    /** Minimize cost'x from the current basis */
+    inline Status iterate(const long maxIter) {
+        computeReducedCosts();
+        bool bland = false;
+        int degenerate = 0;
+
+        while (true) {
+            // pricing (Dantzig, or Bland's rule after many degenerate pivots)
+            int q = -1;
+            double best = 0;
+            for (int j = 0; j < width; j++) if (pos[j] < 0 && lo[j] != up[j]) {
+                double score = 0;
+                if (d[j] < -OPT_TOL && x[j] < up[j]) score = -d[j];
+                else if (d[j] > OPT_TOL && x[j] > lo[j]) score = d[j];
+                if (score > best) {
+                    best = score;
+                    q = j;
+                    if (bland) break;
+                }
+            }
+            if (q < 0) return OPTIMAL;
+            if (iterations >= maxIter) return ITERATION_LIMIT;
+            iterations++;
+
+            const double dir = (d[q] < 0) ? +1.0 : -1.0;
+
+            // ratio test (Harris): largest pivot among the rows blocking within the relaxed step
+            const double flip = up[q] - lo[q];
+            double relaxed = flip;
+            for (int i = 0; i < m; i++) {
+                const double alpha = dir * T[(size_t)i * width + q];
+                const int bv = basis[i];
+                if (alpha > PIVOT_TOL) {
+                    if (lo[bv] > -infinity) relaxed = std::min(relaxed, (x[bv] - lo[bv] + FEAS_TOL) / alpha);
+                }
+                else if (alpha < -PIVOT_TOL) {
+                    if (up[bv] < +infinity) relaxed = std::min(relaxed, (up[bv] - x[bv] + FEAS_TOL) / -alpha);
+                }
+            }
+
+            int r = -1;
+            double step = flip, maxAlpha = 0;
+            for (int i = 0; i < m; i++) {
+                const double alpha = dir * T[(size_t)i * width + q];
+                const int bv = basis[i];
+                double ratio;
+                if (alpha > PIVOT_TOL && lo[bv] > -infinity) ratio = (x[bv] - lo[bv]) / alpha;
+                else if (alpha < -PIVOT_TOL && up[bv] < +infinity) ratio = (up[bv] - x[bv]) / -alpha;
+                else continue;
+                if (ratio <= relaxed && std::abs(alpha) > maxAlpha) {
+                    maxAlpha = std::abs(alpha);
+                    step = std::max(ratio, 0.0);
+                    r = i;
+                }
+            }
+            if (r >= 0 && flip <= step) r = -1, step = flip;
+            if (step >= infinity) return UNBOUNDED;
+
+            // anti-cycling
+            if (step <= FEAS_TOL) {
+                if (++degenerate > 50) bland = true;
+            }
+            else degenerate = 0;
+
+            // move
+            if (step > 0) {
+                for (int i = 0; i < m; i++) x[basis[i]] -= dir * step * T[(size_t)i * width + q];
+            }
+
+            if (r < 0) {
+                // bound flip
+                x[q] = (dir > 0) ? up[q] : lo[q];
+                continue;
+            }
+
+            const int bv = basis[r];
+            x[q] += dir * step;
+            x[bv] = (dir * T[(size_t)r * width + q] > 0) ? lo[bv] : up[bv];
+            pivot(r, q);
+        }
+    }
+
+public:
+    /**
+     * Start a new problem
+     * @param numCols # of structural columns (objective and bounds are set to 0)
+     * @param inf     bounds at least this large (in absolute value) are infinite
+     */
+    inline void reset(const int numCols, const double inf = 1.E20) {
+        assert(numCols >= 0);
+        n = numCols;
+        m = 0;
+        infinity = inf;
+        c.assign(n, 0.0);
+        lb.assign(n, 0.0);
+        ub.assign(n, 0.0);
+        A.clear();
+        sense.clear();
+        b.clear();
+        iterations = 0;
+        objval = 0;
+    }
+
+    /**
+     * Set objective coefficient and bounds of a column
+     * @param j   column index
+     * @param obj objective coefficient
+     * @param l   lower bound
+     * @param u   upper bound
+     */
+    inline void setColumn(const int j, const double obj, const double l, const double u) {
+        assert(j >= 0 && j < n);
+        c[j]  = obj;
+        lb[j] = (l <= -infinity) ? -std::numeric_limits<double>::infinity() : l;
+        ub[j] = (u >= +infinity) ? +std::numeric_limits<double>::infinity() : u;
+    }
+
+    /**
+     * Add a row given in dense form
+     * @param a   coefficients of all n columns
+     * @param sen sense of the row ('L', 'G' or 'E')
+     * @param rhs right-hand side
+     */
+    inline void addRow(const double* a, const char sen, const double rhs) {
+        A.insert(A.end(), a, a + n);
+        sense.push_back(sen);
+        b.push_back(rhs);
+        m++;
+    }
+
+    /**
+     * Add a row given in sparse form
+     * @param nnz # of nonzeros
+     * @param ind column indices
+     * @param val coefficients
+     * @param sen sense of the row ('L', 'G' or 'E')
+     * @param rhs right-hand side
+     */
+    inline void addRow(const int nnz, const int* ind, const double* val, const char sen, const double rhs) {
+        A.resize(A.size() + n, 0.0);
+        double* const a = &A[(size_t)m * n];
+        for (int k = 0; k < nnz; k++) {
+            assert(ind[k] >= 0 && ind[k] < n);
+            a[ind[k]] += val[k];
+        }
+        sense.push_back(sen);
+        b.push_back(rhs);
+        m++;
+    }
+
+    /**
+     * Get # of rows
+     * @return # of rows added so far
+     */
+    inline int getNumRows() const { return m; }
+
+    /**
+     * Solve the problem
+     * @param  maxIter maximum # of simplex iterations (0 = automatic)
+     * @return         solution status
+     */
+    inline Status solve(long maxIter = 0) {
+        const double INF = std::numeric_limits<double>::infinity();
+        if (maxIter <= 0) maxIter = 1000 + 100 * (long)(n + m);
+        iterations = 0;
+        for (int j = 0; j < n; j++) if (lb[j] > ub[j]) return INFEASIBLE;
+
+        // initial point: structural columns at a finite bound (free ones at zero)
+        std::vector<double> xs(n);
+        for (int j = 0; j < n; j++) xs[j] = (lb[j] > -INF) ? lb[j] : ((ub[j] < +INF) ? ub[j] : 0.0);
+
+        // slacks s (a'x + s = b) are basic unless the initial residual violates their bounds
+        artRow.clear();
+        artSign.clear();
+        std::vector<double> slack(m);
+        for (int i = 0; i < m; i++) {
+            double res = b[i];
+            const double* const ai = &A[(size_t)i * n];
+            for (int j = 0; j < n; j++) res -= ai[j] * xs[j];
+            slack[i] = res;
+            const bool feasible = (sense[i] == 'L') ? (res >= 0) : ((sense[i] == 'G') ? (res <= 0) : (res == 0));
+            if (!feasible) {
+                artRow.push_back(i);
+                artSign.push_back((res > 0) ? +1.0 : -1.0);
+            }
+        }
+        const int na = artRow.size();
+        width = n + m + na;
+
+        lo.resize(width);
+        up.resize(width);
+        x.resize(width);
+        pos.assign(width, -1);
+        basis.resize(m);
+        for (int j = 0; j < n; j++) lo[j] = lb[j], up[j] = ub[j], x[j] = xs[j];
+        for (int i = 0; i < m; i++) {
+            lo[n + i] = (sense[i] == 'G') ? -INF : 0.0;
+            up[n + i] = (sense[i] == 'L') ? +INF : 0.0;
+            x[n + i]  = slack[i];
+            basis[i]  = n + i;
+        }
+        for (int a = 0; a < na; a++) {
+            const int i = artRow[a];
+            lo[n + m + a] = 0.0;
+            up[n + m + a] = +INF;
+            x[n + m + a]  = std::abs(slack[i]);
+            x[n + i]      = 0.0;
+            basis[i]      = n + m + a;
+        }
+        for (int i = 0; i < m; i++) pos[basis[i]] = i;
+
+        // tableau B^{-1}[A I Art] for the initial basis (diagonal, entries +-1)
+        T.assign((size_t)m * width, 0.0);
+        for (int i = 0; i < m; i++) {
+            double* const Ti = &T[(size_t)i * width];
+            std::copy(&A[(size_t)i * n], &A[(size_t)i * n] + n, Ti);
+            Ti[n + i] = 1.0;
+        }
+        for (int a = 0; a < na; a++) {
+            double* const Ti = &T[(size_t)artRow[a] * width];
+            if (artSign[a] < 0) for (int k = 0; k < n + m; k++) Ti[k] = -Ti[k];
+            Ti[n + m + a] = 1.0;
+        }
+
+        // phase 1: minimize the sum of artificial variables
+        Status status;
+        if (na > 0) {
+            cost.assign(width, 0.0);
+            for (int a = 0; a < na; a++) cost[n + m + a] = 1.0;
+            status = iterate(maxIter);
+            if (status != OPTIMAL) return (status == UNBOUNDED) ? NUMERICAL_ERROR : status;
+            computeBasicValues();
+
+            double infeas = 0;
+            for (int a = 0; a < na; a++) infeas += x[n + m + a];
+            if (infeas > CHECK_TOL) return INFEASIBLE;
+
+            // artificial variables are fixed at zero from now on
+            for (int a = 0; a < na; a++) {
+                lo[n + m + a] = up[n + m + a] = 0.0;
+                if (pos[n + m + a] < 0) x[n + m + a] = 0.0;
+            }
+        }
+
+        // phase 2: minimize -c'x
+        cost.assign(width, 0.0);
+        for (int j = 0; j < n; j++) cost[j] = -c[j];
+        status = iterate(maxIter);
+        if (status != OPTIMAL) return status;
+        computeBasicValues();
+
+        // verify the solution against the original data
+        for (int j = 0; j < n; j++) {
+            const double tol = CHECK_TOL * (1.0 + std::abs(x[j]));
+            if (x[j] < lb[j] - tol || x[j] > ub[j] + tol) return NUMERICAL_ERROR;
+        }
+        for (int i = 0; i < m; i++) {
+            const double* const ai = &A[(size_t)i * n];
+            double lhs = 0, scale = std::abs(b[i]);
+            for (int j = 0; j < n; j++) {
+                lhs += ai[j] * x[j];
+                scale = std::max(scale, std::abs(ai[j] * x[j]));
+            }
+            const double tol = CHECK_TOL * (1.0 + scale);
+            if ((sense[i] != 'G' && lhs > b[i] + tol) || (sense[i] != 'L' && lhs < b[i] - tol)) return NUMERICAL_ERROR;
+        }
+
+        objval = 0;
+        for (int j = 0; j < n; j++) objval += c[j] * x[j];
+        return OPTIMAL;
+    }
+
+    /**
+     * Get optimal objective value (after solve() returned OPTIMAL)
+     * @return objective value
+     */
+    inline double getObjValue() const { return objval; }
+
+    /**
+     * Get optimal solution (after solve() returned OPTIMAL)
+     * @param sol values of the n structural columns are returned here
+     */
+    inline void getX(std::vector<double>& sol) const { sol.assign(x.begin(), x.begin() + n); }
+
+    /**
+     * Get # of simplex iterations of the last solve
+     * @return # of iterations
+     */
+    inline long getIterations() const { return iterations; }
+};
+
+#endif
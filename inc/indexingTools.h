@@ -24,6 +24,15 @@
 
 // v2: re-arranged order of indices in VarType
 // v3: includes support for a fifth index
+// v4: interned handles of var types with array-indexed queries
+
+// Handle of a var type, as returned by addVarType() or getVarTypeHandle()
+struct VarTypeHandle {
+	int id;
+	explicit VarTypeHandle(const int i = -1) : id(i) {}
+	inline bool isValid() const { return id > -1; }
+};
+
 class VarInfo {
 
 public: 
@@ -41,6 +50,17 @@ public:
 	std::vector <bool> UndefinedVar;  // stores if a specific variable is undefined or not
 	std::vector <int> UndefinedVarCount;  // stores the number of variables undefined up to a specific index
 
+	// same information as VarType, indexed by handle, with the strides of each index:
+	// linear index = First + ind1 * Stride[0] + ... + ind5 * Stride[4] (unused indices have stride 0)
+	struct VarTypeData {
+		int First, Last, numDimensions;
+		int Stride[5];
+	};
+	std::map<std::string, int> VarHandle; // handle of each var type
+	std::vector <VarTypeData> VarTypes;   // [handle] = var type data
+	std::vector <std::string> VarTypeNames; // [handle] = var type name
+	std::vector <int> VarTypeOf;          // [linear index] = handle of the var type it belongs to
+
 	bool isVarTypeConsistent(const int & ind1, const int & ind2, const int & ind3, const int & ind4, const int & ind5);
 
 	void linTo1dIndex(const int & linIndex, const std::tuple <int, int, int, int, int, int, int, int> & VarType, int & ind1) const;
@@ -62,8 +82,11 @@ public:
 	// Clear the object 
 	void clear();
 
-	// Add a new variable type
-	void addVarType(const std::string & name, const char & type, const double & lb, const double & ub, const int & ind1, const int & ind2 = -1, const int & ind3 = -1, const int & ind4 = -1, const int & ind5 = -1);
+	// Add a new variable type and return its handle
+	VarTypeHandle addVarType(const std::string & name, const char & type, const double & lb, const double & ub, const int & ind1, const int & ind2 = -1, const int & ind3 = -1, const int & ind4 = -1, const int & ind5 = -1);
+
+	// get the handle of a var type (invalid handle if there is no var type with this name)
+	VarTypeHandle getVarTypeHandle(const std::string & name) const;
 
 	// set the given var to be undefined
 	void setUndefinedVar(const int & index);
@@ -159,6 +182,72 @@ public:
 	// get the true number of defined vars that this object holds
 	int getTotalDefVarSize() const;
 
+
+	// queries by handle (no string lookups)
+
+	// get the linear index, given the handle and the indices
+	inline int getVarLinIndex(const VarTypeHandle h, const int ind1 = -1, const int ind2 = -1, const int ind3 = -1, const int ind4 = -1, const int ind5 = -1) const {
+		assert(h.id > -1 && h.id < (int)VarTypes.size());
+		const VarTypeData& T = VarTypes[h.id];
+		assert((ind1 > -1) == (T.numDimensions >= 1) && (ind2 > -1) == (T.numDimensions >= 2) && (ind3 > -1) == (T.numDimensions >= 3));
+		assert((ind4 > -1) == (T.numDimensions >= 4) && (ind5 > -1) == (T.numDimensions >= 5));
+		const int index = T.First + ind1 * T.Stride[0] + ind2 * T.Stride[1] + ind3 * T.Stride[2] + ind4 * T.Stride[3] + ind5 * T.Stride[4];
+		assert(index <= T.Last);
+		return index;
+	}
+
+	// get the true linear index of defined var, given the handle and the indices
+	inline int getDefVarLinIndex(const VarTypeHandle h, const int ind1 = -1, const int ind2 = -1, const int ind3 = -1, const int ind4 = -1, const int ind5 = -1) const {
+		const int linIndex = getVarLinIndex(h, ind1, ind2, ind3, ind4, ind5);
+		assert(!UndefinedVar[linIndex]);
+		return linIndex - UndefinedVarCount[linIndex];
+	}
+
+	// get the number of variables of the given type
+	inline int getVarTypeSize(const VarTypeHandle h) const {
+		assert(h.id > -1 && h.id < (int)VarTypes.size());
+		return VarTypes[h.id].Last - VarTypes[h.id].First + 1;
+	}
+
+	// get the number of defined variables of the given type (0 if the handle is invalid)
+	inline int getDefVarTypeSize(const VarTypeHandle h) const {
+		if (!h.isValid()) return 0;
+		assert(h.id < (int)VarTypes.size());
+		const int first = VarTypes[h.id].First;
+		const int last  = VarTypes[h.id].Last;
+		return last - first + 1 - UndefinedVarCount[last] + (first >= 1 ? UndefinedVarCount[first - 1] : 0);
+	}
+
+	// get the linear index of the first var of the given type
+	inline int getFirstOfVarType(const VarTypeHandle h) const {
+		assert(h.id > -1 && h.id < (int)VarTypes.size());
+		return VarTypes[h.id].First;
+	}
+
+	// get the linear index of the last var of the given type
+	inline int getLastOfVarType(const VarTypeHandle h) const {
+		assert(h.id > -1 && h.id < (int)VarTypes.size());
+		return VarTypes[h.id].Last;
+	}
+
+	// get the linear index of the first defined var of the given type
+	int getFirstDefOfVarType(const VarTypeHandle h) const;
+
+	// get the true linear index of the last defined var of the given type
+	int getLastDefOfVarType(const VarTypeHandle h) const;
+
+	// get the handle of the var type of a var, given the linear index
+	inline VarTypeHandle getVarTypeOf(const int & index) const {
+		assert(index > -1 && index < totalVars);
+		return VarTypeHandle(VarTypeOf[index]);
+	}
+
+	// get the name of a var type
+	inline const std::string& getVarTypeName(const VarTypeHandle h) const {
+		assert(h.id > -1 && h.id < (int)VarTypes.size());
+		return VarTypeNames[h.id];
+	}
+
 	// get the true linear index of defined var, given the original index as returned by getVarLinIndex()
 	int getDefVarLinIndex(const int & index) const;
 
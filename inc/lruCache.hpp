@@ -0,0 +1,119 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+#ifndef LRUCACHE_HPP
+#define LRUCACHE_HPP
+
+#include <vector>
+#include <list>
+#include <utility>
+#include <unordered_map>
+#include <functional>
+
+/**
+ * Hash of a vector of integers (e.g., rounded real vectors)
+ */
+struct IntVectorHash {
+    std::size_t operator()(const std::vector<long long>& key) const {
+        std::size_t seed = key.size();
+        for (const auto& v : key) seed ^= std::hash<long long>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
+
+/**
+ * Bounded cache that evicts the least recently used entry when full
+ */
+template <class Key, class Value, class Hash = std::hash<Key> >
+class LRUCache {
+private:
+    /** Entries, most recently used first */
+    std::list<std::pair<Key, Value> > entries;
+
+    /** [key] = position of the entry in the above list */
+    std::unordered_map<Key, typename std::list<std::pair<Key, Value> >::iterator, Hash> index;
+
+    /** Maximum # of entries */
+    std::size_t capacity;
+
+public:
+    /** Statistics */
+    unsigned long hits = 0, misses = 0;
+
+    /**
+     * Construct an empty cache
+     * @param cap maximum # of entries
+     */
+    explicit LRUCache(const std::size_t cap = 1024) : capacity(cap) {}
+
+    /**
+     * Remove all entries (statistics are kept)
+     */
+    inline void clear() {
+        entries.clear();
+        index.clear();
+    }
+
+    /**
+     * Reset the statistics (entries are kept)
+     */
+    inline void resetStats() {
+        hits = misses = 0;
+    }
+
+    /**
+     * Look up a key and mark it as most recently used
+     * @param  key key to be looked up
+     * @return     pointer to the cached value (NULL if not found)
+     */
+    inline const Value* find(const Key& key) {
+        const auto it = index.find(key);
+        if (it == index.end()) {
+            misses++;
+            return NULL;
+        }
+        hits++;
+        entries.splice(entries.begin(), entries, it->second);
+        return &it->second->second;
+    }
+
+    /**
+     * Insert (or overwrite) an entry, evicting the least recently used one if the cache is full
+     * @param key   key of the entry
+     * @param value value of the entry
+     */
+    inline void insert(const Key& key, const Value& value) {
+        const auto it = index.find(key);
+        if (it != index.end()) {
+            it->second->second = value;
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+        if (capacity == 0) return;
+        if (entries.size() >= capacity) {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, value);
+        index.emplace(key, entries.begin());
+    }
+
+    /**
+     * Get the # of cached entries
+     * @return # of entries
+     */
+    inline std::size_t size() const {
+        return entries.size();
+    }
+};
+
+#endif
@@ -0,0 +1,153 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+#ifndef MODELBUILDER_HPP
+#define MODELBUILDER_HPP
+
+#include "constraintExpr.hpp"
+#include <vector>
+#include <string>
+#include <cassert>
+
+/**
+ * Buffers columns and rows of a CPLEX model and adds them with a single
+ * CPXXnewcols / CPXXaddrows call each. Names are kept only if requested,
+ * so callers should check hasNames() before composing them.
+ */
+class ModelBuilder {
+private:
+    /** Store names of columns and rows? */
+    bool names;
+
+    /** Pending columns */
+    std::vector<double> obj, lb, ub;
+    std::vector<char> xctype;
+    std::vector<std::string> colname;
+
+    /** Pending rows */
+    std::vector<double> rhs;
+    std::vector<char> sense;
+    std::vector<CPXNNZ> rmatbeg;
+    std::vector<CPXDIM> rmatind;
+    std::vector<double> rmatval;
+    std::vector<std::string> rowname;
+
+    /** Scratch space */
+    std::vector<CPXDIM> ind;
+    std::vector<double> val;
+    std::vector<const char*> ptr;
+
+    inline const char** namePointers(const std::vector<std::string>& str) {
+        if (!names) return NULL;
+        ptr.resize(str.size());
+        for (unsigned int i = 0; i < str.size(); i++) ptr[i] = str[i].c_str();
+        return ptr.data();
+    }
+
+public:
+    /**
+     * Construct an empty builder
+     * @param withNames store names of columns and rows
+     */
+    explicit ModelBuilder(const bool withNames = true) : names(withNames) {}
+
+    inline bool hasNames() const { return names; }
+    inline CPXDIM getNumCols() const { return obj.size(); }
+    inline CPXDIM getNumRows() const { return rhs.size(); }
+
+    /**
+     * Discard all pending columns and rows
+     */
+    inline void clear() {
+        obj.clear(); lb.clear(); ub.clear(); xctype.clear(); colname.clear();
+        rhs.clear(); sense.clear(); rmatbeg.clear(); rmatind.clear(); rmatval.clear(); rowname.clear();
+    }
+
+    /**
+     * Append a column
+     * @param type  column type
+     * @param lower lower bound
+     * @param upper upper bound
+     * @param coef  objective coefficient
+     * @param name  column name (ignored if names are not stored)
+     */
+    inline void addCol(const char type, const double lower, const double upper, const double coef, const std::string& name = "") {
+        xctype.push_back(type);
+        lb.push_back(lower);
+        ub.push_back(upper);
+        obj.push_back(coef);
+        if (names) colname.push_back(name);
+    }
+
+    /**
+     * Append a row
+     * @param nzcnt    # of nonzeros
+     * @param rowind   column indices
+     * @param rowval   coefficients
+     * @param rowsense sense
+     * @param rowrhs   right-hand side
+     * @param name     row name (ignored if names are not stored)
+     */
+    inline void addRow(const CPXNNZ nzcnt, const CPXDIM* rowind, const double* rowval, const char rowsense, const double rowrhs, const std::string& name = "") {
+        rmatbeg.push_back(rmatind.size());
+        rmatind.insert(rmatind.end(), rowind, rowind + nzcnt);
+        rmatval.insert(rmatval.end(), rowval, rowval + nzcnt);
+        sense.push_back(rowsense);
+        rhs.push_back(rowrhs);
+        if (names) rowname.push_back(name);
+    }
+
+    /**
+     * Append a constraint for fixed values of the uncertain parameters;
+     * same row as ConstraintExpression::addToCplex() without dualization.
+     * Empty constraints are ignored.
+     * @param con         constraint
+     * @param paramValues values of the uncertain parameters (may be empty if con has no q-terms)
+     */
+    inline void addRow(const ConstraintExpression& con, const std::vector<double>& paramValues = {}) {
+        if (con.isEmpty()) return;
+        CPXNNZ nzcnt;
+        double rowrhs;
+        char rowsense;
+        con.getDeterministicConstraint(paramValues, nzcnt, rowrhs, rowsense, ind, val);
+        addRow(nzcnt, ind.data(), val.data(), rowsense, rowrhs, names ? con.getName() : std::string());
+    }
+
+    /**
+     * Add pending columns to the model
+     * @return status of CPXXnewcols (0 on success)
+     */
+    inline int flushCols(CPXCENVptr env, CPXLPptr lp) {
+        int status = 0;
+        if (!obj.empty()) {
+            status = CPXXnewcols(env, lp, obj.size(), obj.data(), lb.data(), ub.data(), xctype.data(), namePointers(colname));
+        }
+        obj.clear(); lb.clear(); ub.clear(); xctype.clear(); colname.clear();
+        return status;
+    }
+
+    /**
+     * Add pending rows to the model
+     * @return status of CPXXaddrows (0 on success)
+     */
+    inline int flushRows(CPXCENVptr env, CPXLPptr lp) {
+        int status = 0;
+        if (!rhs.empty()) {
+            assert(rmatind.size() == rmatval.size());
+            status = CPXXaddrows(env, lp, 0, rhs.size(), rmatind.size(), rhs.data(), sense.data(), rmatbeg.data(), rmatind.data(), rmatval.data(), NULL, namePointers(rowname));
+        }
+        rhs.clear(); sense.clear(); rmatbeg.clear(); rmatind.clear(); rmatval.clear(); rowname.clear();
+        return status;
+    }
+};
+
+#endif
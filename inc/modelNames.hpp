@@ -0,0 +1,70 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+
+#ifndef MODELNAMES_HPP
+#define MODELNAMES_HPP
+
+#include "Constants.h"
+#include <string>
+
+/**
+ * Names of rows and columns of CPLEX models. All names are built with modelName(),
+ * which formats nothing and returns an empty string unless NAME_MODEL_ELEMENTS is set;
+ * empty names are passed to CPLEX as NULL, so models carry no names at all.
+ */
+
+inline void appendNamePart(std::string& str, const std::string& part) { str += part; }
+inline void appendNamePart(std::string& str, const char *part) { str += part; }
+template <typename T>
+inline void appendNamePart(std::string& str, const T part) { str += std::to_string(part); }
+
+inline void appendNameArgs(std::string&) {}
+template <typename T, typename... Args>
+inline void appendNameArgs(std::string& str, const T& first, const Args&... rest) {
+    str += ',';
+    appendNamePart(str, first);
+    appendNameArgs(str, rest...);
+}
+
+/**
+ * Get the name base(arg1,arg2,...) of a model element, e.g., modelName("z", j, k) = "z(j,k)"
+ * @param base   name without indices
+ * @param first  first index (or string)
+ * @param rest   remaining indices (or strings)
+ * @return name, or an empty string if names are not generated
+ */
+inline std::string modelName(const char *base) {
+    return NAME_MODEL_ELEMENTS ? std::string(base) : std::string();
+}
+template <typename T, typename... Args>
+inline std::string modelName(const char *base, const T& first, const Args&... rest) {
+    std::string str;
+    if (NAME_MODEL_ELEMENTS) {
+        str = base;
+        str += '(';
+        appendNamePart(str, first);
+        appendNameArgs(str, rest...);
+        str += ')';
+    }
+    return str;
+}
+
+/**
+ * Get the name of a model element derived from another one, e.g., modelNameSuffix(name, "_l1")
+ * @return name + suffix, or an empty string if name is empty (names are not generated)
+ */
+inline std::string modelNameSuffix(const std::string& name, const char *suffix) {
+    return name.empty() ? std::string() : name + suffix;
+}
+
+#endif
@@ -25,6 +25,7 @@
 
 #include "indexingTools.h"
 #include "constraintExpr.hpp"
+#include "constraintBlock.hpp"
 #include "uncertainty.hpp"
 #include <vector>
 #include <string>
@@ -75,6 +76,11 @@ protected:
     /** Resident larger uncertainty set  for sparation problem*/
     UncertaintySet Uk;
 
+    /** (K, w, revision of U) for which Uk was built (see makeUncSetK) */
+    unsigned int UkK = 0;
+    std::vector<bool> UkW;
+    unsigned long UkRevision = 0;
+
 	/** 1st-stage variables only */
 	VarInfo X;
 
@@ -93,6 +99,10 @@ protected:
 	/** Constraints with 2nd-(and, if applicable, 1st-) stage variables AND uncertain parameters */
 	std::vector<std::vector<ConstraintExpression> > C_XYQ;
 
+	/** Compressed (read-only) copies of C_XQ and C_XYQ used for evaluating and extracting rows at fixed x or q */
+	ConstraintBlock CB_XQ;
+	std::vector<ConstraintBlock> CB_XYQ;
+
 	/** Bound constraints on 1st-stage variables only */
 	std::vector<ConstraintExpression> B_X;
 
@@ -118,10 +128,17 @@ protected:
 	
 	/**
 	 * Define constraints involving 2nd-stage variables
+	 * (only called for policy 0; the other policies are replicated from it, see replicatePolicy())
 	 * @param k policy number to make constraints for
 	 */
 	virtual void makeConsY(unsigned int k = 0) = 0;
 
+	/**
+	 * Define constraints of policy k by shifting the 2nd-stage variables of those of policy 0
+	 * @param k policy number to make constraints for (policies 0, ..., k-1 must exist)
+	 */
+	void replicatePolicy(unsigned int k);
+
 public:
 	/**
 	 * Virtual destructor does nothing
@@ -146,10 +163,17 @@ public:
     
     /**
      * Make a larger uncertainty set 
-     *
+     * (rebuilt only if K, w or the parameters and facets of U changed since the last call)
      */
     void makeUncSetK(unsigned int K);
 
+	/**
+	 * Compile C_XQ and C_XYQ into CB_XQ and CB_XYQ and release the unused capacity of the former;
+	 * must be called whenever the former are modified
+	 * @param first first policy whose constraints were modified (C_XQ is compiled only if 0)
+	 */
+	void compileConstraints(unsigned int first = 0);
+
 	/**
 	 * Check consistency with class design
 	 * @return true if object is conistent with class design
@@ -157,20 +181,37 @@ public:
 	bool isConsistentWithDesign() const;
     
     /**
-     * map indices from x, y^1 to x, y^k
-     * @param  k    k-th policy(start from 0)
+     * map indices from x, y^1 to x, y^k; the map is affine (indices of x are kept, indices of y are shifted by k * numSecondStage)
+     * @param  k          k-th policy(start from 0)
      * @param  rmatind    original indices
-     * @return mapped indices, where the indices of x is the same, y^0 is mapped to y^k
+     * @param  mapped     mapped indices are returned here (may be rmatind itself, memory is reused)
      */
-    const std::vector<int> mapK(const unsigned int k, const std::vector<int>& rmatind);
+    inline void mapK(const unsigned int k, const std::vector<int>& rmatind, std::vector<int>& mapped) const {
+        const int numFirst = numFirstStage;
+        const int offset = k * numSecondStage;
+        mapped.resize(rmatind.size());
+        for (unsigned int i = 0; i < rmatind.size(); i++) {
+            assert(rmatind[i] < getNumVars());
+            mapped[i] = (rmatind[i] < numFirst) ? rmatind[i] : rmatind[i] + offset;
+        }
+    }
     
     /**
-     * map indices from q^1 to q^k
-     * @param  k    k-th policy(start from 0)
+     * map indices from q^1 to q^k; the map is affine (index 0 is kept, other indices are shifted by (k+1) * # of uncertain parameters)
+     * @param  k          k-th policy(start from 0)
      * @param  rmatind    original indices
-     * @return  mapped indices, where the indices of x is the same, y^0 is mapped to y^k
+     * @param  mapped     mapped indices are returned here (may be rmatind itself, memory is reused)
      */
-    const std::vector<int> mapParamK(const unsigned int k, const std::vector<int>& rmatind);
+    inline void mapParamK(const unsigned int k, const std::vector<int>& rmatind, std::vector<int>& mapped) const {
+        const int numParam = getNoOfUncertainParameters();
+        const int offset = (k + 1) * numParam;
+        assert(numParam > 0);
+        mapped.resize(rmatind.size());
+        for (unsigned int i = 0; i < rmatind.size(); i++) {
+            assert(rmatind[i] <= numParam);
+            mapped[i] = (rmatind[i] == 0) ? 0 : rmatind[i] + offset;
+        }
+    }
     
     void setW(const std::vector<bool>& wInput);
     
@@ -192,7 +233,14 @@ public:
 	 * @param  ind4 fourth index
 	 * @return      the linear index of the variable
 	 */
-	inline int getVarIndex_1(const std::string type, const int ind1, const int ind2 = -1, const int ind3 = -1, const int ind4 = -1) const {
+	inline int getVarIndex_1(const std::string& type, const int ind1, const int ind2 = -1, const int ind3 = -1, const int ind4 = -1) const {
+		return X.getDefVarLinIndex(type, ind1, ind2, ind3, ind4);
+	}
+
+	/**
+	 * Linear variable index of 1st-stage variable, given the handle of its type (see VarInfo::getVarTypeHandle)
+	 */
+	inline int getVarIndex_1(const VarTypeHandle type, const int ind1, const int ind2 = -1, const int ind3 = -1, const int ind4 = -1) const {
 		return X.getDefVarLinIndex(type, ind1, ind2, ind3, ind4);
 	}
 
@@ -209,7 +257,14 @@ public:
 	 * @param  ind4 fourth index
 	 * @return      the linear index of the variable
 	 */
-	inline int getVarIndex_2(const unsigned int k, const std::string type, const int ind1, const int ind2 = -1, const int ind3 = -1, const int ind4 = -1) const {
+	inline int getVarIndex_2(const unsigned int k, const std::string& type, const int ind1, const int ind2 = -1, const int ind3 = -1, const int ind4 = -1) const {
+		return numFirstStage + (k * numSecondStage) + Y.getDefVarLinIndex(type, ind1, ind2, ind3, ind4);
+	}
+
+	/**
+	 * Linear variable index of 2nd-stage variable, given the handle of its type (see VarInfo::getVarTypeHandle)
+	 */
+	inline int getVarIndex_2(const unsigned int k, const VarTypeHandle type, const int ind1, const int ind2 = -1, const int ind3 = -1, const int ind4 = -1) const {
 		return numFirstStage + (k * numSecondStage) + Y.getDefVarLinIndex(type, ind1, ind2, ind3, ind4);
 	}
     
@@ -378,6 +433,22 @@ public:
 		return C_XYQ;
 	}
 
+	/**
+	 * Get compressed constraints with 1st-stage variables AND uncertain parameters
+	 * @return compressed copy of C_XQ
+	 */
+	inline const decltype(CB_XQ)& getBlockXQ() {
+		return CB_XQ;
+	}
+
+	/**
+	 * Get compressed constraints with 2nd-(and, if applicable, 1st-) stage variables AND uncertain parameters
+	 * @return compressed copies of C_XYQ (one per policy)
+	 */
+	inline const decltype(CB_XYQ)& getBlockXYQ() {
+		return CB_XYQ;
+	}
+
 	/**
 	 * Get bound constraints on 1st-stage variables only
 	 * @return bound constraints on 1st-stage variables only
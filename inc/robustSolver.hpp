@@ -25,6 +25,9 @@
 
 #include "problemInfo.hpp"
 #include "problemInfo_knp_dd.hpp"
+#include "solverTrace.hpp"
+#include "rowBatch.hpp"
+#include "cutPool.hpp"
 #include <ilcplex/cplexx.h>
 #include <vector>
 
@@ -111,6 +114,13 @@ public:
      */
     unsigned int getNumPolicies(const std::vector<double>& x) const;
 
+    /**
+     * Return the policy to which a column of the K-adaptable model belongs
+     * @param  j column index
+     * @return   policy number of column j (-1 if j is a 1st-stage column)
+     */
+    int getPolicyOfColumn(const int j) const;
+
     /**
      * Resize the K'-adaptable solution x to the size of a K-adaptable solution
      * @param x candidate solution
@@ -139,9 +149,9 @@ public:
      * map indices from x, y^1 to x, y^k
      * @param  k    k-th policy(start from 0)
      * @param  rmatind    original indices
-     * @return mapped indices, where the indices of x is the same, y^0 is mapped to y^k
+     * @param  mapped     mapped indices are returned here, where the indices of x is the same, y^0 is mapped to y^k
      */
-    inline const std::vector<int> mapK(const unsigned int k, const std::vector<int>& rmatind) {return pInfo->mapK(k, rmatind);}
+    inline void mapK(const unsigned int k, const std::vector<int>& rmatind, std::vector<int>& mapped) const {pInfo->mapK(k, rmatind, mapped);}
 
 
 
@@ -193,42 +203,25 @@ public:
     /**
      * Get all constraints involving uncertain parameters and first-stage variables using realization q
      * @param q       candidate scenario
-     * @param rcnt    # of constraints will be returned here (size of rhs, sense, rmatbeg)
-     * @param nzcnt   # of non-zeros across all constraints (size of rmatind, rmatval)
-     * @param rhs     rhs of each constraint
-     * @param sense   sense of each constraint
-     * @param rmatbeg rmatbeg[i] = starting position of constraint i in rmatind/rmatval, rmatbeg[0] = 0
-     * @param rmatind linear indices of variables appearing in constraints
-     * @param rmatval coefficients of variables appearing in constraints
+     * @param rows    constraints are returned here (linear indices of variables; previous contents are removed)
      */
-    void getXQ_fixedQ(const std::vector<double>& q, CPXDIM& rcnt, CPXNNZ& nzcnt, std::vector<double>& rhs, std::vector<char>& sense, std::vector<CPXNNZ>& rmatbeg, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const;
+    void getXQ_fixedQ(const std::vector<double>& q, RowBatch& rows) const;
 
     /**
      * Get all constraints involving uncertain parameters and first-stage variables using decisions x
      * @param x       candidate solution
-     * @param rcnt    # of constraints will be returned here (size of rhs, sense, rmatbeg)
-     * @param nzcnt   # of non-zeros across all constraints (size of rmatind, rmatval)
-     * @param rhs     rhs of each constraint
-     * @param sense   sense of each constraint
-     * @param rmatbeg rmatbeg[i] = starting position of constraint i in rmatind/rmatval, rmatbeg[0] = 0
-     * @param rmatind linear indices of parameters appearing in constraints
-     * @param rmatval coefficients of parameters appearing in constraints
+     * @param rows    constraints are returned here (linear indices of parameters; previous contents are removed)
      */
-    void getXQ_fixedX(const std::vector<double>& x, CPXDIM& rcnt, CPXNNZ& nzcnt, std::vector<double>& rhs, std::vector<char>& sense, std::vector<CPXNNZ>& rmatbeg, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const;
+    void getXQ_fixedX(const std::vector<double>& x, RowBatch& rows) const;
 
     /**
      * Get all constraints involving uncertain parameters in policy k using realization q
      * @param k       policy for which to get constraints
      * @param q       candidate scenario
-     * @param rcnt    # of constraints will be returned here (size of rhs, sense, rmatbeg)
-     * @param nzcnt   # of non-zeros across all constraints (size of rmatind, rmatval)
-     * @param rhs     rhs of each constraint
-     * @param sense   sense of each constraint
-     * @param rmatbeg rmatbeg[i] = starting position of constraint i in rmatind/rmatval, rmatbeg[0] = 0
-     * @param rmatind linear indices of variables appearing in constraints
-     * @param rmatval coefficients of variables appearing in constraints
-     */
-    void getYQ_fixedQ(const unsigned int k, const std::vector<double>& q, CPXDIM& rcnt, CPXNNZ& nzcnt, std::vector<double>& rhs, std::vector<char>& sense, std::vector<CPXNNZ>& rmatbeg, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const;
+     * @param rows    constraints are returned here (linear indices of variables)
+     * @param append  keep the rows already in rows (otherwise they are removed)
+     */
+    void getYQ_fixedQ(const unsigned int k, const std::vector<double>& q, RowBatch& rows, const bool append = false) const;
     
     /**
      * Get the single constraint labelCstr involving uncertain parameters in policy k using realization q
@@ -247,28 +240,16 @@ public:
      * Get all constraints involving uncertain parameters in policy k using decisions x
      * @param k       policy for which to get constraints
      * @param x       candidate solution
-     * @param rcnt    # of constraints will be returned here (size of rhs, sense, rmatbeg)
-     * @param nzcnt   # of non-zeros across all constraints (size of rmatind, rmatval)
-     * @param rhs     rhs of each constraint
-     * @param sense   sense of each constraint
-     * @param rmatbeg rmatbeg[i] = starting position of constraint i in rmatind/rmatval, rmatbeg[0] = 0
-     * @param rmatind linear indices of parameters appearing in constraints
-     * @param rmatval coefficients of parameters appearing in constraints
+     * @param rows    constraints are returned here (linear indices of parameters; previous contents are removed)
      */
-    void getYQ_fixedX(const unsigned int k, const std::vector<double>& x, CPXDIM& rcnt, CPXNNZ& nzcnt, std::vector<double>& rhs, std::vector<char>& sense, std::vector<CPXNNZ>& rmatbeg, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const;
+    void getYQ_fixedX(const unsigned int k, const std::vector<double>& x, RowBatch& rows) const;
 
     /**
      * Get all cutting constraints for the inner problem using constraint generation method, only caculate for policy 0 for effciency reason, map to other policy constraint later.
      * @param q     current uncertainty, where w \circ \xi = w \circ q
-     * @param rcnt    # of constraints will be returned here (size of rhs, sense, rmatbeg)
-     * @param nzcnt   # of non-zeros across all constraints (size of rmatind, rmatval)
-     * @param rhs     rhs of each constraint
-     * @param sense   sense of each constraint
-     * @param rmatbeg rmatbeg[i] = starting position of constraint i in rmatind/rmatval, rmatbeg[0] = 0
-     * @param rmatind linear indices of parameters appearing in constraints
-     * @param rmatval coefficients of parameters appearing in constraints
-     */
-    void getRobustYQ_fixedQ(const std::vector<double>& q, CPXDIM& rcnt, CPXNNZ& nzcnt, std::vector<double>& rhs, std::vector<char>& sense, std::vector<CPXNNZ>& rmatbeg, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval);
+     * @param rows    cutting constraints are returned here (previous contents are removed)
+     */
+    void getRobustYQ_fixedQ(const std::vector<double>& q, RowBatch& rows);
     
     /**
      * Add the projection of the feasible set defined by constraint don't have bilinear term to the w space
@@ -386,6 +367,21 @@ public:
      */
     bool feasible_RobustYQ(const std::vector<double>& x, const std::vector<std::vector<double> >& samples, std::vector<double>& q, int & labelCstr, int & labelq, bool heur = 0) const;
 
+    /**
+     * Overload of previous function that returns up to m violations, at most one per scenario
+     * (the most violated constraint of each scenario), sorted by decreasing violation
+     * [to be used by internal routines only]
+     *
+     * @param  x         candidate solution
+     * @param  samples   collection of scenarios to check feasibility against
+     * @param  m         maximum # of violations to be returned
+     * @param  qs        worst-case scenarios of the uncertainty set (qs[i][0] = violation)
+     * @param  labelCstr numbers of the violated constraints
+     * @param  labelq    labels of the violating scenarios
+     * @return           true if feasible
+     */
+    bool feasible_RobustYQ(const std::vector<double>& x, const std::vector<std::vector<double> >& samples, const unsigned int m, std::vector<std::vector<double> >& qs, std::vector<int>& labelCstr, std::vector<int>& labelq, bool heur = 0) const;
+
 
 
 
@@ -470,7 +466,19 @@ public:
      * @return      solve status (non-zero value indicates unsuccessful termination)
      */
     int solve_ScSRO(const std::vector<std::vector<double> >& samples, std::vector<double>& x) const;
-    
+
+    /**
+     * Construct a K-adaptable solution by clustering the scenarios according to the
+     * activity of the 2nd-stage constraints at x, and assigning each cluster to a policy
+     * @param  samples collection of scenarios to be clustered
+     * @param  x       current (node) solution used to measure constraint activity
+     * @param  K       # of 2nd-stage policies (= # of clusters)
+     * @param  timeLimit time limit (in seconds) of the restricted scenario-based problem
+     * @param  xheur   solution of the restricted scenario-based problem (if any) will be returned here
+     * @return         solve status (non-zero value indicates unsuccessful termination)
+     */
+    int solve_ClusteredScSRO(const std::vector<std::vector<double> >& samples, const std::vector<double>& x, const unsigned int K, const double timeLimit, std::vector<double>& xheur) const;
+
     /**
      * Solve the inner robust problem using cutting plane method
      * @param  qini     samples xi to be added as initial constraint
@@ -489,6 +497,9 @@ public:
     /** Library of samples (temporary var -- to be used by solve_YQRobust_cuttingplane() only) */
     std::vector<std::vector<double> > inner_samples;
 
+    /** Cut pool of the running cutting-plane solve (see ScopedCutPool), NULL if none is running */
+    CutPool* cutPool = NULL;
+
     /** Feasible (ideally optimal) static robust solution -- to be used by solve_KAdaptability() only) */
     std::vector<double> xstatic;
 
@@ -505,6 +516,20 @@ public:
      * Assignment of the \bar{\xi} to policies in the optimal node, work with bb_samples_all to get gradient
      */
     std::vector<std::vector<int> > final_labels;
+
+    /** (time, incumbent, bound, nodes) trajectory of the last call to solve_KAdaptability() */
+    SolverTrace bb_trace;
+
+    /** CSV file bb_trace is written to at the end of solve_KAdaptability() (no export if empty) */
+    std::string traceFileName;
+
+    /**
+     * Set the CSV file the trace of solve_KAdaptability() is written to
+     * @param fileName name of the file (overwritten by every solve), empty to disable the export
+     */
+    inline void setTraceFile(const std::string& fileName) {
+        traceFileName = fileName;
+    }
     
     /**
      * Get best solution found
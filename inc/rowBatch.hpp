@@ -0,0 +1,96 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+#ifndef ROWBATCH_HPP
+#define ROWBATCH_HPP
+
+#include <ilcplex/cplexx.h>
+#include <vector>
+#include <cassert>
+
+/**
+ * Rows in the format of CPXXaddrows (rhs, sense, rmatbeg, rmatind, rmatval).
+ * clear() keeps the allocated memory, so a batch that is reused across calls
+ * stops allocating once it has grown to the largest size needed.
+ */
+class RowBatch {
+public:
+    /** # of rows (size of rhs, sense, rmatbeg) */
+    CPXDIM rcnt;
+
+    /** # of non-zeros across all rows (size of rmatind, rmatval) */
+    CPXNNZ nzcnt;
+
+    /** rhs and sense of each row */
+    std::vector<double> rhs;
+    std::vector<char> sense;
+
+    /** rmatbeg[i] = starting position of row i in rmatind/rmatval, rmatbeg[0] = 0 */
+    std::vector<CPXNNZ> rmatbeg;
+
+    /** Indices and coefficients of the non-zeros */
+    std::vector<CPXDIM> rmatind;
+    std::vector<double> rmatval;
+
+    RowBatch() : rcnt(0), nzcnt(0) {}
+
+    /**
+     * Remove all rows (memory is kept for reuse)
+     */
+    inline void clear() {
+        rcnt = 0;
+        nzcnt = 0;
+        rhs.clear();
+        sense.clear();
+        rmatbeg.clear();
+        rmatind.clear();
+        rmatval.clear();
+    }
+
+    /**
+     * Start a new (empty) row; its non-zeros are appended to rmatind/rmatval
+     * by the caller, who must then add their number to nzcnt
+     * @param rowsense sense of the row
+     * @param rowrhs   rhs of the row
+     */
+    inline void addRow(const char rowsense = 'L', const double rowrhs = 0) {
+        rcnt++;
+        rhs.push_back(rowrhs);
+        sense.push_back(rowsense);
+        rmatbeg.push_back(rmatind.size());
+    }
+
+    /**
+     * Get position of the first non-zero of row i in rmatind/rmatval
+     */
+    inline CPXNNZ rowBegin(const CPXDIM i) const { return rmatbeg[i]; }
+
+    /**
+     * Get position after the last non-zero of row i in rmatind/rmatval
+     */
+    inline CPXNNZ rowEnd(const CPXDIM i) const { return (i + 1 == rcnt) ? nzcnt : rmatbeg[i + 1]; }
+
+    /**
+     * Get # of non-zeros of row i
+     */
+    inline CPXNNZ rowSize(const CPXDIM i) const { return rowEnd(i) - rowBegin(i); }
+
+    /**
+     * Do the sizes of all arrays agree with rcnt and nzcnt?
+     */
+    inline bool isConsistent() const {
+        return (CPXDIM)rhs.size() == rcnt && (CPXDIM)sense.size() == rcnt && (CPXDIM)rmatbeg.size() == rcnt
+            && (CPXNNZ)rmatind.size() == nzcnt && (CPXNNZ)rmatval.size() == nzcnt;
+    }
+};
+
+#endif
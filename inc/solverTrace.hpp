@@ -0,0 +1,119 @@
+/******************************************************************************************/
+/*                                                                                        */
+/*  Copyright 2024 by Qing Jin, Angelos Georghiou, Phebe Vayanos and Grani A. Hanasusanto */
+/*                                                                                        */
+/*  Licensed under the FreeBSD License (the "License").                                   */
+/*  You may not use this file except in compliance with the License.                      */
+/*  You may obtain a copy of the License at                                               */
+/*                                                                                        */
+/*  https://www.freebsd.org/copyright/freebsd-license.html                                */
+/*                                                                                        */
+/******************************************************************************************/
+
+#ifndef SOLVERTRACE_HPP
+#define SOLVERTRACE_HPP
+
+#include <vector>
+#include <ostream>
+#include <iomanip>
+#include <cassert>
+
+/**
+ * Single point of the (time, incumbent, bound, nodes) trajectory of a branch-and-bound solve
+ */
+struct TracePoint {
+    /** Wall-clock time elapsed since the start of the solve (sec) */
+    double time;
+
+    /** Objective value of the incumbent (+inf if none) */
+    double incumbent;
+
+    /** Best remaining bound */
+    double bound;
+
+    /** # of nodes processed so far */
+    long long nodes;
+};
+
+/**
+ * Fixed-capacity trace of the primal and dual bound trajectories of a solve.
+ *
+ * Memory never exceeds the capacity given at reset(): when the buffer is full,
+ * every other point is dropped and only every 2nd subsequent point is recorded
+ * (decimation), so that the trace always covers the whole solve with a
+ * resolution that degrades gracefully. Forced points (e.g., incumbent updates)
+ * bypass the sampling stride but are subject to decimation like any other point.
+ */
+class SolverTrace {
+private:
+    /** Recorded points (in chronological order) */
+    std::vector<TracePoint> points;
+
+    /** Maximum # of points kept */
+    unsigned int capacity = 1024;
+
+    /** Record only every stride-th offered point */
+    unsigned long stride = 1;
+
+    /** # of points offered since the last recorded point */
+    unsigned long offered = 0;
+
+    /** Drop every other point and halve the sampling rate */
+    inline void decimate() {
+        unsigned int j = 0;
+        for (unsigned int i = 0; i < points.size(); i += 2) points[j++] = points[i];
+        // always keep the latest point
+        if (points.size() % 2 == 0) points[j++] = points.back();
+        points.resize(j);
+        stride *= 2;
+    }
+
+public:
+    /**
+     * Clear the trace and set its capacity
+     * @param cap maximum # of points to be kept (must be at least 2)
+     */
+    inline void reset(const unsigned int cap = 1024) {
+        assert(cap >= 2);
+        points.clear();
+        points.reserve(cap);
+        capacity = cap;
+        stride = 1;
+        offered = 0;
+    }
+
+    /**
+     * Offer a new point to the trace
+     * @param p     new point
+     * @param force record the point regardless of the sampling stride
+     */
+    inline void record(const TracePoint& p, const bool force = false) {
+        if (!force && (++offered < stride)) return;
+        offered = 0;
+        if (points.size() == capacity) decimate();
+        points.emplace_back(p);
+    }
+
+    /**
+     * Get the recorded points
+     * @return recorded points in chronological order
+     */
+    inline const std::vector<TracePoint>& getPoints() const {
+        return points;
+    }
+
+    /**
+     * Write the trace in CSV format (time,incumbent,bound,nodes)
+     * @param out output stream
+     */
+    inline void write(std::ostream& out) const {
+        out << "time,incumbent,bound,nodes\n";
+        for (const auto& p : points) {
+            out << std::setprecision(6) << std::fixed << p.time << ",";
+            out << std::setprecision(10) << std::defaultfloat << p.incumbent << ",";
+            out << p.bound << "," << p.nodes << "\n";
+        }
+    }
+};
+
+#endif
@@ -28,6 +28,10 @@
 #include <vector>
 #include <string>
 #include <utility>
+#include <map>
+#include <memory>
+#include "lruCache.hpp"
+#include "denseSimplex.hpp"
 
 
 
@@ -42,38 +46,267 @@ protected:
 	/** # of uncertain parameters */
 	int N;
 
-	/** Nominal realization */
-	std::vector<double> nominal;
+	/** Parameters and facets of the set (immutable while shared between copies, see mutableGeometry()) */
+	struct Geometry {
+		/** Construct the geometry of an empty set (row 0 of all arrays is unused) */
+		Geometry() : nominal(1, 0.0), low(1, 0.0), high(1, 0.0), polytope_beg(2, 0), polytope_sense(1, 'L') {}
 
-	/** Lower bounds on uncertain parameters */
-	std::vector<double> low;
+		/** Nominal realization */
+		std::vector<double> nominal;
 
-	/** Upper bounds on uncertain parameters */
-	std::vector<double> high;
-	
-	/** Constraint matrix defining uncertainty set (including bounds) */
-	std::vector<std::vector<double> > polytope_W;
+		/** Lower bounds on uncertain parameters */
+		std::vector<double> low;
 
-	/** Matrix of zeros (backward compatibility) */
-	std::vector<std::vector<double> > polytope_V;
-	
-	/** Corresponding right hand side vector */
-	std::vector<double> polytope_h;
+		/** Upper bounds on uncertain parameters */
+		std::vector<double> high;
+
+		/**
+		 * Constraint matrix W defining uncertainty set (including bounds) in compressed sparse row form:
+		 * the nonzeros of row r are polytope_ind/polytope_val[polytope_beg[r] .. polytope_beg[r+1]),
+		 * sorted by parameter index
+		 */
+		std::vector<int> polytope_beg;
+		std::vector<int> polytope_ind;
+		std::vector<double> polytope_val;
+
+		/* Sense of each constraint */
+		std::vector<char> polytope_sense;
+
+		/** Rows of W that are facets, i.e., not bound rows (passed to the solver as rows rather than column bounds) */
+		std::vector<int> facetRows;
+
+		/** vector for the associated observation decision variables*/
+		std::vector<int> obsVar;
+
+		/**
+		 * Append a row to W, dropping zeros; if an index appears more than once, the last coefficient is kept
+		 * @param nnz # of entries
+		 * @param ind parameter indices (1..N)
+		 * @param val coefficients
+		 */
+		void appendRowW(const int nnz, const int* ind, const double* val);
+	};
 
-	/* Corresponding sense of each constraint */
-	std::vector<char> polytope_sense;
+	/** Parameters and facets of the set (shared between copies) */
+	std::shared_ptr<Geometry> geom;
+
+	/**
+	 * Right hand side vector of Wq [sense] h; rows 2i-1 and 2i hold the current bounds of q(i) (see setXiBar)
+	 * (immutable while shared between copies, see mutableRHS())
+	 */
+	std::shared_ptr<std::vector<double> > polytope_h;
     
     /** w vector*/
     std::vector<bool> w;
-    
-    /** vector for the associated observation decision variables*/
-    std::vector<int> obsVar;
 
-	/** Solver environment to carry out optimizations on uncertainty set */
-	CPXENVptr env;
+	/**
+	 * Get geometry for modification, copying it first if it is shared with other sets
+	 * @return geometry owned by this set only
+	 */
+	Geometry& mutableGeometry();
+
+	/**
+	 * Get right hand side vector for modification, copying it first if it is shared with other sets
+	 * @return right hand side vector owned by this set only
+	 */
+	std::vector<double>& mutableRHS();
 
-	/** Solver problem object to carry out above optimizations */
-	CPXLPptr lp;
+	/** CPLEX environment shared by the sets whose solver objects were created in the same thread (see getSolverLP()) */
+	struct SolverEnv;
+	mutable std::shared_ptr<SolverEnv> envHandle;
+
+	/** Solver environment to carry out optimizations on uncertainty set (NULL until needed) */
+	mutable CPXENVptr env;
+
+	/** Solver problem object to carry out above optimizations (NULL until needed, freed whenever the set is modified) */
+	mutable CPXLPptr lp;
+
+	/**
+	 * Get the solver problem object, building it from the parameters, facets and current bounds if necessary
+	 * (obtains a solver environment from the pool of the calling thread if the set has none)
+	 * @return solver problem object (max tau over the set, tau with unit objective)
+	 */
+	CPXLPptr getSolverLP() const;
+
+	/**
+	 * Free the solver problem object and all separation LPs
+	 * (must be called whenever the parameters or facets change)
+	 */
+	void freeSolverLP() const;
+
+	/** Revision of the set (unique among all sets, renewed whenever the set or its bounds change) */
+	unsigned long revision;
+
+	/** Revision at which parameters or facets last changed (i.e., not renewed by setXiBar and resetXiBar) */
+	unsigned long structureRevision;
+
+	/** Have the bounds of observed parameters (polytope_h) changed since they were last passed to the solver? */
+	mutable bool boundsDirty;
+
+	/**
+	 * Pass the current bounds of observed parameters to lp and all separation LPs
+	 * (one batched call per solver object; must be called before any of them is solved or cloned)
+	 */
+	void syncBounds() const;
+
+	/** Persistent separation LPs (see solveSeparationLP()), one per row pattern */
+	mutable std::map<std::vector<std::vector<int> >, CPXLPptr> sepLP;
+
+	/** Results of recent separation problems, keyed on the rounded rows and the current bounds of observed parameters */
+	mutable LRUCache<std::vector<long long>, std::vector<double>, IntVectorHash> sepCache;
+
+	/** Scratch buffers of solveSeparationLP() (cache key, objective of the closed-form maximization) */
+	mutable std::vector<long long> sepKey;
+	mutable std::vector<double> sepCoef;
+
+	/**
+	 * Free all persistent separation LPs
+	 * (must be called whenever the uncertainty set is modified other than through w)
+	 */
+	void freeSeparationLPs() const;
+
+	/** Structures of uncertainty sets for which linear functions are maximized in closed form */
+	enum SetStructure {
+		STRUCT_UNKNOWN, /* not yet detected */
+		STRUCT_GENERAL, /* none of the below (solve LP) */
+		STRUCT_BOX,     /* bounds only */
+		STRUCT_BUDGET,  /* bounds + a single inequality facet */
+		STRUCT_FACTOR   /* bounds + equality facets, each defining one parameter as an affine function of the others */
+	};
+
+	/** Sparse facet used by the closed-form maximizers */
+	struct SparseFacet {
+		/** Parameter defined by this facet (STRUCT_FACTOR only) */
+		int dep;
+
+		/** Sense and right hand side (STRUCT_FACTOR: q(dep) = rhs - terms) */
+		char sense;
+		double rhs;
+
+		/** Nonzero coefficients (STRUCT_FACTOR: excluding q(dep), divided by its coefficient) */
+		std::vector<std::pair<int, double> > terms;
+	};
+
+	/** Structure of the set (recognized lazily, reset whenever the set is modified) */
+	mutable SetStructure structure;
+
+	/** Facets of the set in sparse form (STRUCT_BUDGET, STRUCT_FACTOR) */
+	mutable std::vector<SparseFacet> structFacets;
+
+	/**
+	 * Recognize the structure of the set
+	 */
+	void detectStructure() const;
+
+	/**
+	 * Maximize a linear function over the set without solving an LP, if its structure allows it
+	 * @param  coef   coefficients of the uncertain parameters (1-indexed, size 1 + N)
+	 * @param  result argmax is returned here (1-indexed)
+	 * @param  val    optimal value is returned here
+	 * @return        false if the problem must be solved by the LP solver instead
+	 */
+	bool maxClosedForm(const std::vector<double>& coef, std::vector<double>& result, double& val) const;
+
+	/** Reduced form of the set in terms of the parameters y that remain after presolve() */
+	struct PresolvedSet {
+		/** Is the reduced form available? (false if the set is not an LP or presolve detected infeasibility) */
+		bool valid = false;
+
+		/** Structure revision and observed parameters for which the form was computed (0 = never computed) */
+		unsigned long structureRevision = 0;
+		std::vector<bool> observed;
+
+		/**
+		 * q(i) = off[i] + mult[i] * y(col[i]) if col[i] >= 0, q(i) = off[i] + mult[i] * q(obs[i]) if obs[i] > 0,
+		 * and q(i) = off[i] otherwise, i = 1..N (obs[i] is an observed parameter, known only at solve time)
+		 */
+		std::vector<int> col, obs;
+		std::vector<double> mult, off;
+
+		/** Bounds of y */
+		std::vector<double> lb, ub;
+
+		/** Remaining facets in sparse form (columns 1..size of y; column 0 is reserved for tau) */
+		std::vector<std::vector<int> > rowInd;
+		std::vector<std::vector<double> > rowVal;
+		std::vector<char> sense;
+		std::vector<double> rhs;
+
+		/** Terms of each remaining facet in the observed parameters (moved to the right-hand side at solve time) */
+		std::vector<std::vector<int> > rowObsInd;
+		std::vector<std::vector<double> > rowObsVal;
+	};
+
+	/**
+	 * Reduced forms of the set with all parameters free and with the parameters in w observed;
+	 * neither depends on the observed values, so a new sample does not require a new presolve
+	 */
+	mutable PresolvedSet presolvedFree, presolvedObs;
+
+	/**
+	 * Compute the reduced form of the set at its current structure: bound rows become bounds,
+	 * bounds are tightened, parameters defined by 2-term equalities or fixed by their bounds are
+	 * substituted out, and redundant or duplicate facets are removed. Observed parameters are
+	 * left unbounded and never substituted out, as their values are filled in at solve time
+	 * @param observed observed parameters (observed[i-1] for q(i), as in w; empty if none)
+	 * @param P        reduced form is returned here
+	 */
+	void presolve(const std::vector<bool>& observed, PresolvedSet& P) const;
+
+	/** Built-in solver for small LPs over the set (see solveDenseLP()) and its scratch row */
+	mutable DenseSimplex denseLP;
+	mutable std::vector<double> denseRow;
+
+	/**
+	 * Solve max obj'(tau, q) over the set intersected with additional rows (in <= form) with the
+	 * built-in dense simplex instead of CPLEX, using the reduced form of the set; tau is free
+	 * @param  obj    objective coefficients (size 1 + N)
+	 * @param  ind    column indices of each additional row (0 = tau, i = q(i))
+	 * @param  val    coefficients of each additional row
+	 * @param  rhs    right-hand side of each additional row
+	 * @param  result optimal (tau, q) is returned here
+	 * @param  objval optimal value is returned here
+	 * @return        false if the LP is too large, not supported or not solved to optimality (the next backend must then be used)
+	 */
+	bool solveDenseLP(const std::vector<double>& obj, const std::vector<std::vector<int> >& ind, const std::vector<std::vector<double> >& val, const std::vector<double>& rhs, std::vector<double>& result, double& objval) const;
+
+	/**
+	 * Solve max obj'(tau, q) over the set intersected with additional rows (in <= form) with CPLEX, on lp if there
+	 * are no additional rows and on the persistent separation LP of the row pattern otherwise (objective must be tau)
+	 * @return solution status of the LP (see solveDenseLP() for the other arguments)
+	 */
+	int solveCplexLP(const std::vector<double>& obj, const std::vector<std::vector<int> >& ind, const std::vector<std::vector<double> >& val, const std::vector<double>& rhs, std::vector<double>& result, double& objval) const;
+
+	/** Solver of the LPs over the set, i.e., max obj'(tau, q) over the set intersected with additional rows (in <= form), tau free */
+	class LPBackend {
+	public:
+		virtual ~LPBackend() {}
+
+		/** Name of the backend (in messages) */
+		virtual const char* name() const = 0;
+
+		/**
+		 * Solve an LP over a set
+		 * @param  U      uncertainty set (holds the solver objects of the backend)
+		 * @return        solution status (CPX_STAT_OPTIMAL if solved; see solveDenseLP() for the other arguments)
+		 */
+		virtual int solve(const UncertaintySet& U, const std::vector<double>& obj, const std::vector<std::vector<int> >& ind, const std::vector<std::vector<double> >& val, const std::vector<double>& rhs, std::vector<double>& result, double& objval) const = 0;
+	};
+
+	/** Built-in dense simplex on the reduced form of the set (small LPs only, see solveDenseLP()) */
+	class DenseBackend;
+
+	/** CPLEX (see solveCplexLP()) */
+	class CplexBackend;
+
+	/** Backends in the order in which they are tried (the dense simplex first, if enabled) */
+	static const std::vector<const LPBackend*>& lpBackends();
+
+	/**
+	 * Solve an LP over the set with the first backend that solves it (see lpBackends())
+	 * @return solution status of the last backend tried (see solveDenseLP() for the arguments)
+	 */
+	int solveLP(const std::vector<double>& obj, const std::vector<std::vector<int> >& ind, const std::vector<std::vector<double> >& val, const std::vector<double>& rhs, std::vector<double>& result, double& objval) const;
 
 
 
@@ -120,6 +353,22 @@ public:
 	 */
 	void addFacet(const std::vector<std::pair<int, double> >& input, const char sense, const double rhs);
 
+	/**
+	 * Replace the set by the given parameters and facets, passed to the solver with one call each
+	 * (same set as clear() followed by addParam() for every parameter, then addFacet() for every facet)
+	 * @param nom    nominal values of parameters 1, ..., n (0-indexed)
+	 * @param lo     lower bounds of the parameters
+	 * @param hi     upper bounds of the parameters
+	 * @param rowBeg facet r has terms [rowBeg[r], rowBeg[r+1]) (the last one ends at rowInd.size())
+	 * @param rowInd parameter indices (in 1, ..., n) of the terms
+	 * @param rowVal coefficients of the terms
+	 * @param sense  senses of the facets ('L', 'G', 'E')
+	 * @param rhs    rhs of the facets
+	 */
+	void assign(const std::vector<double>& nom, const std::vector<double>& lo, const std::vector<double>& hi,
+	            const std::vector<int>& rowBeg, const std::vector<int>& rowInd, const std::vector<double>& rowVal,
+	            const std::vector<char>& sense, const std::vector<double>& rhs);
+
 	/**
 	 * Compute the maximum of a linear function of uncertain parameters over the uncertainty set
 	 * @param  input  the list of uncertain parameters and their coefficients in the linear function
@@ -136,6 +385,19 @@ public:
 	 */
 	double min(const std::vector<std::pair<int, double> >& input, std::vector<double>& result) const;
 
+	/**
+	 * Solve the separation problem max { tau : val[p]'(tau, q) <= rhs[p] for all p, q in set }.
+	 * The LP is kept between calls: if the rows have the same sparsity pattern as in an
+	 * earlier call, only their coefficients and right-hand sides are updated and the
+	 * solver warm-starts from the previous basis. Results of recent calls are cached.
+	 * @param  ind    column indices of each row (0 = tau, i = q(i)); no duplicates within a row
+	 * @param  val    coefficients of each row
+	 * @param  rhs    right-hand side of each row
+	 * @param  result optimal (tau, q) is returned here (if solved to optimality)
+	 * @return        solution status of the LP
+	 */
+	int solveSeparationLP(const std::vector<std::vector<int> >& ind, const std::vector<std::vector<double> >& val, const std::vector<double>& rhs, std::vector<double>& result) const;
+
 	/**
 	 * Overload of previous function (to maintain backward compatibility)
 	 * @param  ind  the list of indices of the uncertain parameters
@@ -174,6 +436,7 @@ public:
     
     /**
      * Set w \circ \xi = w \circ \bar{\xi}
+     * (the solver objects are updated lazily, see syncBounds())
      * @param  xi_bar   input sample
      */
     void setXiBar(const std::vector<double>& xi_bar);
@@ -199,19 +462,19 @@ public:
 	 * Get nominal realization
 	 * @return the nominal realization
 	 */
-	inline std::vector<double> getNominal() const { return nominal; }
+	inline std::vector<double> getNominal() const { return geom->nominal; }
 
 	/** 
 	 * Get lower bounds of uncertain parameters
 	 * @return the lower bounds
 	 */
-	inline std::vector<double> getLowerBounds() const { return low; }
+	inline std::vector<double> getLowerBounds() const { return geom->low; }
 
 	/** 
 	 * Get upper bounds of uncertain parameters
 	 * @return the upper bounds
 	 */
-	inline std::vector<double> getUpperBounds() const { return high; }
+	inline std::vector<double> getUpperBounds() const { return geom->high; }
 
 	/**
 	 * Get clone of solver model object representing uncertainty set
@@ -219,20 +482,49 @@ public:
 	 * @param  stat pointer to solve status of clone operation
 	 * @return      pointer to clone of solver model object
 	 */
-	inline CPXLPptr getLPObject(CPXCENVptr env_, int *stat) const { return CPXXcloneprob(env_, lp, stat); }
+	inline CPXLPptr getLPObject(CPXCENVptr env_, int *stat) const { CPXLPptr lp_ = getSolverLP(); syncBounds(); return CPXXcloneprob(env_, lp_, stat); }
 	
 	/**
 	 * Get clone of solver model object representing uncertainty set
 	 * @param  stat pointer to solve status of clone operation
 	 * @return      pointer to clone of solver model object
 	 */
-	inline CPXLPptr getLPObject(int *stat) const { return getLPObject(env, stat); }
+	inline CPXLPptr getLPObject(int *stat) const { getSolverLP(); return getLPObject(env, stat); }
 
 	/**
 	 * Get pointer to solver environment to carry out optimizations on uncertainty set
 	 * @return pointer to solver environment
 	 */
-	inline CPXENVptr getENVObject() const { return env; }
+	inline CPXENVptr getENVObject() const { getSolverLP(); return env; }
+
+	/**
+	 * Get revision of the uncertainty set, e.g., to detect whether models derived from it are outdated
+	 * @return revision number (different for any two sets or states of the same set)
+	 */
+	inline unsigned long getRevision() const { return revision; }
+
+	/**
+	 * Get revision of the parameters and facets of the uncertainty set (ignores changes of the bounds of observed parameters)
+	 * @return revision number
+	 */
+	inline unsigned long getStructureRevision() const { return structureRevision; }
+
+	/**
+	 * Get # of separation problems answered from the cache
+	 * @return # of cache hits
+	 */
+	inline unsigned long getSeparationCacheHits() const { return sepCache.hits; }
+
+	/**
+	 * Get # of separation problems not found in the cache
+	 * @return # of cache misses
+	 */
+	inline unsigned long getSeparationCacheMisses() const { return sepCache.misses; }
+
+	/**
+	 * Reset the # of cache hits and misses of the separation problems (cached results are kept)
+	 */
+	inline void resetSeparationCacheStats() const { sepCache.resetStats(); }
 
 	/**
 	 * Is the uncertainty set empty?
@@ -244,7 +536,7 @@ public:
 	 * Get number of constraints defining uncertainty set (other than bound constraints)
 	 * @return number of facets of uncertainty set
 	 */
-	inline int getNoOfFacets() const { return polytope_h.size(); }
+	inline int getNoOfFacets() const { return polytope_h->size(); }
 
 	/**
 	 * Get number of uncertain parameters
@@ -267,28 +559,53 @@ public:
 	inline int getNumBudgetsFactors() const { return 0; }
 
 	/**
-	 * Get constraint matrix W in Wq [sense] h
+	 * Sparse view of a row of W; valid until the set is modified
+	 */
+	struct RowView {
+		int nnz;
+		const int* ind;
+		const double* val;
+	};
+
+	/**
+	 * Get row of constraint matrix W in Wq [sense] h
+	 * @param  r row index (1-indexed, rows 2i-1 and 2i are the bounds of q(i))
+	 * @return   view of the nonzeros of row r
+	 */
+	inline RowView getRowW(const int r) const {
+		const int beg = geom->polytope_beg[r];
+		return RowView{geom->polytope_beg[r + 1] - beg, geom->polytope_ind.data() + beg, geom->polytope_val.data() + beg};
+	}
+
+	/**
+	 * Get # of nonzeros of constraint matrix W
+	 * @return # of nonzeros
+	 */
+	inline int getNnzW() const { return geom->polytope_ind.size(); }
+
+	/**
+	 * Get constraint matrix W in Wq [sense] h as a dense matrix (built on demand; prefer getRowW())
 	 * @return constraint matrix W
 	 */
-	inline std::vector<std::vector<double> > getMatrixW() const { return polytope_W; }
+	std::vector<std::vector<double> > getMatrixW() const;
 
 	/**
-	 * Get constraint matrix V
+	 * Get constraint matrix V (a column of zeros, built on demand; backward compatibility)
 	 * @return constraint matrix V
 	 */
-	inline std::vector<std::vector<double> > getMatrixV() const { return polytope_V; }
+	inline std::vector<std::vector<double> > getMatrixV() const { return std::vector<std::vector<double> >(polytope_h->size(), std::vector<double>(1, 0)); }
 
 	/**
 	 * Get vector h in Wq [sense] h
 	 * @return right hand side vector h
 	 */
-	inline std::vector<double> getMatrixH() const { return polytope_h; }
+	inline std::vector<double> getMatrixH() const { return *polytope_h; }
 
 	/**
 	 * Get vector h in Wq [sense] h
 	 * @return right hand side vector h
 	 */
-	inline std::vector<char> getMatrixSense() const { return polytope_sense; }
+	inline std::vector<char> getMatrixSense() const { return geom->polytope_sense; }
 };
 
 typedef const UncertaintySet* UNCSetCPtr;
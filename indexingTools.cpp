@@ -149,10 +149,14 @@ void VarInfo::clear() {
 	ObjCoefficient.clear();
 	UndefinedVar.clear();
 	UndefinedVarCount.clear();
+	VarHandle.clear();
+	VarTypes.clear();
+	VarTypeNames.clear();
+	VarTypeOf.clear();
 }
 
-// Add a new variable type
-void VarInfo::addVarType(const std::string & name, const char & type, const double & lb, const double & ub, const int & ind1, const int & ind2, const int & ind3, const int & ind4, const int & ind5) {
+// Add a new variable type and return its handle
+VarTypeHandle VarInfo::addVarType(const std::string & name, const char & type, const double & lb, const double & ub, const int & ind1, const int & ind2, const int & ind3, const int & ind4, const int & ind5) {
 	int first = 0;
 	if(VarType.size() > 0) {
 		first = totalVars;
@@ -184,7 +188,7 @@ void VarInfo::addVarType(const std::string & name, const char & type, const doub
 	totalVars = first + size;
 	int last = first + size -1;
 	auto temp = std::make_tuple(first, last, numDimensions, ind1, ind2, ind3, ind4, ind5);
-	VarType.emplace(name, temp);
+	const bool inserted = VarType.emplace(name, temp).second;
 	UpperBound.resize(totalVars, ub);
 	LowerBound.resize(totalVars, lb);
 	ColumnType.resize(totalVars, type);
@@ -193,6 +197,35 @@ void VarInfo::addVarType(const std::string & name, const char & type, const doub
 	UndefinedVarCount.resize(totalVars, (UndefinedVarCount.empty() ? 0 : UndefinedVarCount.back()) );
 
 	if(isVarTypeConsistent(ind1, ind2, ind3, ind4, ind5) != true) abortProgram("Var Type not valid");
+
+	// existing key: keep its data (as VarType does)
+	if(!inserted) {
+		VarTypeOf.resize(totalVars, -1);
+		return VarTypeHandle(VarHandle.at(name));
+	}
+
+	// strides: product of the sizes of the subsequent indices
+	VarTypeData data;
+	const int sizes[5] = {ind1, ind2, ind3, ind4, ind5};
+	data.First = first;
+	data.Last = last;
+	data.numDimensions = numDimensions;
+	for(int d = 4, stride = 1; d >= 0; d--) {
+		data.Stride[d] = (d < numDimensions) ? stride : 0;
+		if(d < numDimensions) stride *= sizes[d];
+	}
+	const int handle = VarTypes.size();
+	VarTypes.push_back(data);
+	VarTypeNames.push_back(name);
+	VarHandle.emplace(name, handle);
+	VarTypeOf.resize(totalVars, handle);
+	return VarTypeHandle(handle);
+}
+
+// get the handle of a var type
+VarTypeHandle VarInfo::getVarTypeHandle(const std::string & name) const {
+	const auto it = VarHandle.find(name);
+	return VarTypeHandle(it == VarHandle.end() ? -1 : it->second);
 }
 
 // // set the vector of undefined vars
@@ -309,38 +342,34 @@ int VarInfo::getTotalDefVarSize() const {
 
 // get the name and the indices, given the linear index
 void VarInfo::getVarInfo(const int & linIndex, std::string &type, int & ind1, int & ind2, int & ind3, int & ind4, int & ind5) const {
-	bool found = false;
-	for(auto it = VarType.cbegin(); it != VarType.cend(); ++it) {
-		int firstOf = std::get<0>((*it).second);
-		int lastOf  = std::get<1>((*it).second);
-		if(linIndex >= firstOf && linIndex <= lastOf) {
-			found = true;
-			type = (*it).first;
-			linToIndex(linIndex, (*it).second, ind1, ind2, ind3, ind4, ind5);
-		}
+	if(linIndex < 0 || linIndex >= (int)VarTypeOf.size() || VarTypeOf[linIndex] < 0) abortProgram("Variable not found (getVarInfo)");
+	const VarTypeData& T = VarTypes[VarTypeOf[linIndex]];
+	type = VarTypeNames[VarTypeOf[linIndex]];
+	int ind[5] = {-1, -1, -1, -1, -1};
+	int diff = linIndex - T.First;
+	for(int d = 0; d < T.numDimensions; d++) {
+		ind[d] = diff / T.Stride[d]; diff -= ind[d] * T.Stride[d];
 	}
-	if(!found) abortProgram("Variable not found (getVarInfo)");
+	ind1 = ind[0]; ind2 = ind[1]; ind3 = ind[2]; ind4 = ind[3]; ind5 = ind[4];
 }
 
 // get the linear index, given the name and the indices
 int VarInfo::getVarLinIndex(const std::string & type, const int ind1, const int ind2, const int ind3, const int ind4, const int ind5) const {
-	if(VarType.find(type) == VarType.end()) { // key not found
+	const VarTypeHandle h = getVarTypeHandle(type);
+	if(!h.isValid()) { // key not found
 		abortProgram("Unknown Variable key (getVarLinIndex)");
 		return 0;
 	}
-	else {
-		return xdIndicesToLinIndex(VarType.at(type), ind1, ind2, ind3, ind4, ind5);
-	}
+	return getVarLinIndex(h, ind1, ind2, ind3, ind4, ind5);
 }
 
 // get the linear index of defined variable, given the name and the indices
 int VarInfo::getDefVarLinIndex(const std::string & type, const int ind1, const int ind2, const int ind3, const int ind4, const int ind5) const {
-	if(VarType.find(type) == VarType.end()) { // key not found
+	const VarTypeHandle h = getVarTypeHandle(type);
+	if(!h.isValid()) { // key not found
 		abortProgram("Unknown Variable key (getDefVarLinIndex)");
 	}
-	const int linIndex = xdIndicesToLinIndex(VarType.at(type), ind1, ind2, ind3, ind4, ind5);
-	assert(!UndefinedVar[linIndex]);
-	return linIndex - UndefinedVarCount[linIndex];
+	return getDefVarLinIndex(h, ind1, ind2, ind3, ind4, ind5);
 }
 
 // get the linear index of defined variable, given the original index
@@ -351,47 +380,44 @@ int VarInfo::getDefVarLinIndex(const int & index) const {
 
 // get the number of variables of the requested type
 int VarInfo::getVarTypeSize(const std::string & name) const {
-	if(VarType.find(name) == VarType.end()) {
+	const VarTypeHandle h = getVarTypeHandle(name);
+	if(!h.isValid()) {
 		abortProgram("Invalid key (getVarTypeSize)");
 	}
-
-	const int elements = std::get<1>(VarType.at(name)) - std::get<0>(VarType.at(name)) + 1;
-	return elements;
+	return getVarTypeSize(h);
 }
 
 // get the number of defined variables of the requested type
 int VarInfo::getDefVarTypeSize(const std::string & name) const {
-	if(VarType.find(name) == VarType.end()) {
-        // if no variable type, return 0
-		// abortProgram("Invalid key (getVarTypeSize)");
-        return 0;
-	}
-	const int last  = std::get<1>(VarType.at(name));
-	const int first = std::get<0>(VarType.at(name));
-	int elements = last - first + 1 - UndefinedVarCount[last];
-	if (first >= 1) {
-		elements += UndefinedVarCount[first - 1];
-	}
-	return elements;
+	// if no variable type, return 0
+	return getDefVarTypeSize(getVarTypeHandle(name));
 }
 
 // get the linear index of the first var of a given var type  (iterating tool)
 int VarInfo::getFirstOfVarType(const std::string & name) const {
-	if(VarType.find(name) == VarType.end()) abortProgram("invalid var key (getFirstOfVarType)");
-	return std::get<0> (VarType.at(name));
+	const VarTypeHandle h = getVarTypeHandle(name);
+	if(!h.isValid()) abortProgram("invalid var key (getFirstOfVarType)");
+	return getFirstOfVarType(h);
 }
 
 // get the linear index of the last var of a given var type (iterating tool)
 int VarInfo::getLastOfVarType(const std::string & name) const {
-	if(VarType.find(name) == VarType.end()) abortProgram("invalid var key (getLastOfVarType)");
-	return std::get<1> (VarType.at(name));
+	const VarTypeHandle h = getVarTypeHandle(name);
+	if(!h.isValid()) abortProgram("invalid var key (getLastOfVarType)");
+	return getLastOfVarType(h);
 }
 
 // get the linear index of the first defined var of a given var type  (iterating tool)
 int VarInfo::getFirstDefOfVarType(const std::string & name) const {
-	if(VarType.find(name) == VarType.end()) abortProgram("invalid var key (getFirstOfDefVarType)");
-	int first = std::get<0> (VarType.at(name));
-	const int last = std::get<1> (VarType.at(name));
+	const VarTypeHandle h = getVarTypeHandle(name);
+	if(!h.isValid()) abortProgram("invalid var key (getFirstOfDefVarType)");
+	return getFirstDefOfVarType(h);
+}
+
+// get the linear index of the first defined var of the given type (iterating tool)
+int VarInfo::getFirstDefOfVarType(const VarTypeHandle h) const {
+	int first = getFirstOfVarType(h);
+	const int last = getLastOfVarType(h);
 	while (UndefinedVar[first] && first <= last) first++;
 	if (first > last) abortProgram("All variables of type are undefined (getFirstOfDefVarType)");
     return first;
@@ -400,9 +426,15 @@ int VarInfo::getFirstDefOfVarType(const std::string & name) const {
 
 // get the linear index of the last defined var of a given var type (iterating tool)
 int VarInfo::getLastDefOfVarType(const std::string & name) const {
-	if(VarType.find(name) == VarType.end()) abortProgram("invalid var key (getLastOfLastVarType)");
-	int last = std::get<1> (VarType.at(name));
-	const int first = std::get<0> (VarType.at(name));
+	const VarTypeHandle h = getVarTypeHandle(name);
+	if(!h.isValid()) abortProgram("invalid var key (getLastOfLastVarType)");
+	return getLastDefOfVarType(h);
+}
+
+// get the true linear index of the last defined var of the given type (iterating tool)
+int VarInfo::getLastDefOfVarType(const VarTypeHandle h) const {
+	int last = getLastOfVarType(h);
+	const int first = getFirstOfVarType(h);
 	while(UndefinedVar[last] && last >= first) last--;
 	if (last < first) abortProgram("All variables of type are undefined (getLastOfDefVarType)");
 	return getDefVarLinIndex(last);
@@ -410,19 +442,8 @@ int VarInfo::getLastDefOfVarType(const std::string & name) const {
 
 // get the variable name, given the linear index
 std::string VarInfo::getVarName(const int & index) const {
-	bool found = false;
-	std::string type;
-	for(auto it = VarType.cbegin(); it != VarType.cend(); ++it) {
-		int firstOf = std::get<0>((*it).second);
-		int lastOf  = std::get<1>((*it).second);
-		if(index >= firstOf && index <= lastOf) {
-			found = true;
-			type = (*it).first;
-			return type;
-		}
-	}
-	if(!found) abortProgram("Variable not found (getVarName)");
-	return "";
+	if(index < 0 || index >= (int)VarTypeOf.size() || VarTypeOf[index] < 0) abortProgram("Variable not found (getVarName)");
+	return VarTypeNames[VarTypeOf[index]];
 }
 
 // query if a var is undefined
@@ -23,6 +23,7 @@
 
 #include "problemInfo.hpp"
 #include <cassert>
+#include <algorithm>
 
 
 //-----------------------------------------------------------------------------------
@@ -34,7 +35,7 @@ void KAdaptableInfo::resize(unsigned int K) {
     if (numPolicies < K){
         numPolicies = K;
         for (unsigned int k = l; k < numPolicies; k++)
-            makeConsY(k);
+            replicatePolicy(k);
     }
     else{
         numPolicies = K;
@@ -46,15 +47,52 @@ void KAdaptableInfo::resize(unsigned int K) {
     }
     
     makeUncSetK(K);
+    compileConstraints(std::min(l, K));
     
 	assert(isConsistentWithDesign());
 }
 
+void KAdaptableInfo::replicatePolicy(unsigned int k) {
+	assert(k >= 1);
+	assert(B_Y.size() == k && C_XY.size() == k && C_XYQ.size() == k);
+
+	const int offset = k * numSecondStage;
+	const std::string suffix = NAME_MODEL_ELEMENTS ? "_" + std::to_string(k) : std::string();
+
+	B_Y.emplace_back();
+	C_XY.emplace_back();
+	C_XYQ.emplace_back();
+	B_Y[k].reserve(B_Y[0].size());
+	C_XY[k].reserve(C_XY[0].size());
+	C_XYQ[k].reserve(C_XYQ[0].size());
+	for (const auto& con : B_Y[0])  B_Y[k].emplace_back(con.shiftVars(numFirstStage, offset, suffix));
+	for (const auto& con : C_XY[0]) C_XY[k].emplace_back(con.shiftVars(numFirstStage, offset, suffix));
+	for (const auto& con : C_XYQ[0]) C_XYQ[k].emplace_back(con.shiftVars(numFirstStage, offset, suffix));
+}
+
+void KAdaptableInfo::compileConstraints(unsigned int first) {
+	// the expressions are kept next to the blocks (the CPLEX model is built from them): keep only their terms
+	if (first == 0) {
+		for (auto& con : C_XQ) con.shrink_to_fit();
+		CB_XQ.assign(C_XQ);
+	}
+	CB_XYQ.resize(C_XYQ.size());
+	for (unsigned int k = first; k < C_XYQ.size(); k++) {
+		for (auto& con : C_XYQ[k]) con.shrink_to_fit();
+		CB_XYQ[k].assign(C_XYQ[k]);
+	}
+}
+
 void KAdaptableInfo::makeUncSetK(unsigned int K)
 {
     
     if(K<=1){
+        // a copy of U in its current state
+        if(UkK == 1 && UkRevision == U.getRevision()) return;
         Uk = U;
+        UkK = 1;
+        UkW.clear();
+        UkRevision = U.getRevision();
         //std::cout << "no need to enlarge the uncertainty set." << std::endl;
         return;
     }
@@ -65,8 +103,9 @@ void KAdaptableInfo::makeUncSetK(unsigned int K)
         //std::cout << "no need to enlarge the uncertainty set for decision independent case." << std::endl;
         return;
     }
-        
-    Uk.clear();
+
+    // bounds of observed parameters are not used below, so only changes of the parameters and facets of U matter
+    if(UkK == K && UkW == w && UkRevision == U.getStructureRevision()) return;
     
     // get all data from uncertainty set U
     int numPara = U.getNoOfUncertainParameters();
@@ -76,57 +115,66 @@ void KAdaptableInfo::makeUncSetK(unsigned int K)
     std::vector<double> lowQ = U.getLowerBounds();
     std::vector<double> highQ = U.getUpperBounds();
     // constraints defining facets
-    std::vector<std::vector<double> > WQ = U.getMatrixW();
-    std::vector<std::vector<double> > VQ = U.getMatrixV();
     std::vector<double> HQ = U.getMatrixH();
     std::vector<char> senseQ = U.getMatrixSense();
     
-    // build \bar{\xi} matrix
-    // first create all parameters
-    for(int i = 1; i <= numPara; i++){
-        Uk.addParam(nominalQ[i], lowQ[i], highQ[i]);
+    // parameters: \bar{\xi}, \xi^1, ..., \xi^K
+    std::vector<double> nom, lo, hi;
+    for(unsigned int l = 0; l <= K; l++){
+        nom.insert(nom.end(), nominalQ.begin() + 1, nominalQ.end());
+        lo.insert(lo.end(), lowQ.begin() + 1, lowQ.end());
+        hi.insert(hi.end(), highQ.begin() + 1, highQ.end());
     }
-    // then add all facets
-    // capture data in constraint, do it one time for efficiency
-    std::vector<std::vector<std::pair<int, double>>> constraints;
+
+    // facets of U (sparse, without the bound rows)
+    std::vector<int> facetBeg, facetInd;
+    std::vector<double> facetVal;
     for(int i = 1 + 2*numPara; i < numFacets; i++){
-        std::vector<std::pair<int, double>> constraint;
-        for(int j = 1; j <= numPara; j++){
-            if(WQ[i][j])
-                constraint.emplace_back(std::make_pair(j, WQ[i][j]));
-        }
-        Uk.addFacet(constraint, senseQ[i], HQ[i]);
-        constraints.emplace_back(constraint);
+        facetBeg.emplace_back(facetInd.size());
+        const auto row = U.getRowW(i);
+        facetInd.insert(facetInd.end(), row.ind, row.ind + row.nnz);
+        facetVal.insert(facetVal.end(), row.val, row.val + row.nnz);
     }
-    
-    assert(Uk.getNoOfFacets() == numFacets);
-    for(unsigned int l = 1; l <= K; l++){
-        // add parameter \xi^l
-        for(int i = 1; i <= numPara; i++){
-            Uk.addParam(nominalQ[i], lowQ[i], highQ[i]);
-        }
-        // add facets
+    facetBeg.emplace_back(facetInd.size());
+
+    // facets of each copy, followed by w \circ \bar{\xi} = w \circ \xi^l
+    std::vector<int> rowBeg, rowInd;
+    std::vector<double> rowVal, rhs;
+    std::vector<char> sense;
+    unsigned int numW = 0;
+    for(unsigned int l = 0; l <= K; l++){
         for(int i = 1 + 2*numPara; i < numFacets; i++){
-            int j = i - 1 - 2*numPara;
-            for(unsigned int x = 0; x < constraints[j].size(); x++){
-                constraints[j][x].first += numPara;
+            const int f = i - 1 - 2*numPara;
+            rowBeg.emplace_back(rowInd.size());
+            for(int t = facetBeg[f]; t < facetBeg[f + 1]; t++){
+                rowInd.emplace_back(facetInd[t] + l*numPara);
+                rowVal.emplace_back(facetVal[t]);
             }
-            Uk.addFacet(constraints[j], senseQ[i], HQ[i]);
+            sense.emplace_back(senseQ[i]);
+            rhs.emplace_back(HQ[i]);
         }
-        // add constraint w \circ \bar{\xi} = w \circ \xi
-        unsigned int numW = 0;
+        if(l == 0) continue;
+        numW = 0;
         for(int i = 0; i < numPara; i++){
             if(w[i]){
-                std::vector<std::pair<int, double>> constraint;
-                constraint.emplace_back(std::make_pair(i+1, 1));
-                constraint.emplace_back(std::make_pair(l*numPara+i+1, -1));
-                Uk.addFacet(constraint, 'E', 0);
+                rowBeg.emplace_back(rowInd.size());
+                rowInd.insert(rowInd.end(), {i+1, int(l*numPara)+i+1});
+                rowVal.insert(rowVal.end(), {1, -1});
+                sense.emplace_back('E');
+                rhs.emplace_back(0);
                 numW++;
             }
         }
-        assert(Uk.getNoOfFacets() == int(numFacets + (numFacets + numW - 1) * l) );
     }
-    
+
+    // load everything at once
+    Uk.assign(nom, lo, hi, rowBeg, rowInd, rowVal, sense, rhs);
+    assert(Uk.getNoOfUncertainParameters() == int((K + 1) * numPara));
+    assert(Uk.getNoOfFacets() == int((K + 1) * (numFacets - 1) + 1 + K * numW));
+
+    UkK = K;
+    UkW = w;
+    UkRevision = U.getStructureRevision();
 }
 
 //-----------------------------------------------------------------------------------
@@ -136,6 +184,11 @@ bool KAdaptableInfo::isConsistentWithDesign() const {
 	if (numPolicies < 1) return 0;
 	if (C_XY.size() != numPolicies) return 0;
 	if (C_XYQ.size() != numPolicies) return 0;
+	if (CB_XYQ.size() != numPolicies) return 0;
+	if (CB_XQ.size() != C_XQ.size()) return 0;
+	for (unsigned int p = 0; p < numPolicies; p++) {
+		if (CB_XYQ[p].size() != C_XYQ[p].size()) return 0;
+	}
 	if (B_Y.size() != numPolicies) return 0;
 	if (X.getTotalDefVarSize() <= 0) return 0;
 	if (Y.getTotalDefVarSize() < 0) return 0;
@@ -221,45 +274,6 @@ bool KAdaptableInfo::isConsistentWithDesign() const {
 
 
 //-----------------------------------------------------------------------------------
-const std::vector<int> KAdaptableInfo::mapK(const unsigned int k, const std::vector<int>& rmatind)
-{
-    std::vector<int> rmatindNew;
-    rmatindNew.clear();
-    
-    int numFirst = getNumFirstStage();
-    int numSecond = getNumSecondStage();
-    int numVar = getNumVars();
-    for(int ind : rmatind){
-        assert(ind < numVar);
-        rmatindNew.emplace_back(ind < numFirst? ind : ind + k*numSecond);
-    }
-    
-    assert(rmatind.size() == rmatindNew.size());
-    
-    return rmatindNew;
-}
-
-const std::vector<int> KAdaptableInfo::mapParamK(const unsigned int k, const std::vector<int>& rmatind)
-{
-    assert(getUncSetK().getNoOfUncertainParameters());
-    
-    std::vector<int> rmatindNew;
-    rmatindNew.clear();
-
-    int numParam = getNoOfUncertainParameters();
-    for(int ind : rmatind){
-        assert(ind <= numParam);
-        if(ind == 0)
-            rmatindNew.emplace_back(0);
-        else
-            rmatindNew.emplace_back(ind + (k+1)*numParam);
-    }
-    
-    assert(rmatind.size() == rmatindNew.size());
-    
-    return rmatindNew;
-}
-
 void KAdaptableInfo::setW(const std::vector<bool>& wInput)
 {
     int startw(X.getFirstDefOfVarType("w") - X.getFirstOfVarType("w"));
@@ -231,6 +231,7 @@ void KAdaptableInfo_BB::makeVars() {
 //-----------------------------------------------------------------------------------
 
 void KAdaptableInfo_BB::makeConsX() {
+    const VarTypeHandle hW = X.getVarTypeHandle("w");
     ConstraintExpression temp;
 
     /////////
@@ -241,14 +242,14 @@ void KAdaptableInfo_BB::makeConsX() {
     // bounds on w(i)
     for (int i = 0; i <= data.N-1; ++i) {
         temp.clear();
-        temp.addTermX(getVarIndex_1("w", i), 1);
+        temp.addTermX(getVarIndex_1(hW, i), 1);
 
-        temp.rowname("LB_w(" + std::to_string(i) + ")");
+        temp.rowname(modelName("LB_w", i));
         temp.sign('G');
         temp.RHS(0);
         B_X.emplace_back(temp);
 
-        temp.rowname("UB_w(" + std::to_string(i) + ")");
+        temp.rowname(modelName("UB_w", i));
         temp.sign('L');
         temp.RHS(1);
         B_X.emplace_back(temp);
@@ -263,10 +264,10 @@ void KAdaptableInfo_BB::makeConsX() {
     if(!CSTR_UNC){
         temp.clear();
         for (int i = 0; i <= data.N-1; ++i) if (data.profit[i] != 0.0) {
-            temp.rowname("BUDGET");
+            temp.rowname(modelName("BUDGET"));
             temp.sign('L');
             temp.RHS(data.B);
-            temp.addTermX(getVarIndex_1("w", i), data.cost[i]);
+            temp.addTermX(getVarIndex_1(hW, i), data.cost[i]);
         }
         C_X.emplace_back(temp);
         //temp.print();
@@ -281,11 +282,11 @@ void KAdaptableInfo_BB::makeConsX() {
     // In this problem, this constraint only involve w, so we add it into the problem through the function robustifyW in the outerloop
     if(CSTR_UNC){
         temp.clear();
-        temp.rowname("BUDGET");
+        temp.rowname(modelName("BUDGET"));
         temp.sign('L');
         temp.RHS(data.B);
         for (int i = 0; i <= data.N-1; ++i) if (data.profit[i] != 0.0) {
-            temp.addTermProduct(getVarIndex_1("w", i), data.phi[0].size() + + data.N + i, 1.0);
+            temp.addTermProduct(getVarIndex_1(hW, i), data.phi[0].size() + + data.N + i, 1.0);
         }
         C_XQ.emplace_back(temp);
     }
@@ -294,6 +295,8 @@ void KAdaptableInfo_BB::makeConsX() {
 //-----------------------------------------------------------------------------------
 
 void KAdaptableInfo_BB::makeConsY(unsigned int l) {
+    const VarTypeHandle hO = X.getVarTypeHandle("O"), hW = X.getVarTypeHandle("w"), hPsi = X.getVarTypeHandle("psi");
+    const VarTypeHandle hY = Y.getVarTypeHandle("y");
     assert(C_XY.size() == B_Y.size());
     assert(C_XY.size() == C_XYQ.size());
     assert(numPolicies >= l);
@@ -315,14 +318,14 @@ void KAdaptableInfo_BB::makeConsY(unsigned int l) {
         // bounds on y(i)
         for (int i = 0; i <= data.N-1; ++i) {
             temp.clear();
-            temp.addTermX(getVarIndex_2(k, "y", i), 1);
+            temp.addTermX(getVarIndex_2(k, hY, i), 1);
 
-            temp.rowname("LB_y(" + std::to_string(i) + "," + std::to_string(k) + ")");
+            temp.rowname(modelName("LB_y", i, k));
             temp.sign('G');
             temp.RHS(0);
             B_Y[k].emplace_back(temp);
 
-            temp.rowname("UB_y(" + std::to_string(i) + "," + std::to_string(k) + ")");
+            temp.rowname(modelName("UB_y", i, k));
             temp.sign('L');
             temp.RHS(1);
             B_Y[k].emplace_back(temp);
@@ -341,11 +344,11 @@ void KAdaptableInfo_BB::makeConsY(unsigned int l) {
         // take only after open
         for (int i = 0; i <= data.N-1; ++i) {
             temp.clear();
-            temp.rowname("TAKE(" + std::to_string(i) + "," + std::to_string(k) + ")");
+            temp.rowname(modelName("TAKE", i, k));
             temp.sign('L');
             temp.RHS(0.0);
-            temp.addTermX(getVarIndex_1("w", i), -1.0);
-            temp.addTermX(getVarIndex_2(k, "y", i), 1.0);
+            temp.addTermX(getVarIndex_1(hW, i), -1.0);
+            temp.addTermX(getVarIndex_2(k, hY, i), 1.0);
             // temp.addTermX(getVarIndex_2(k, "z", i), -1.0);
 
             C_XY[k].emplace_back(temp);
@@ -355,10 +358,10 @@ void KAdaptableInfo_BB::makeConsY(unsigned int l) {
         // take only one
         temp.clear();
         for (int i = 0; i <= data.N-1; ++i) if (data.profit[i] != 0.0) {
-            temp.rowname("ONE(" + std::to_string(k) + ")");
+            temp.rowname(modelName("ONE", k));
             temp.sign('L');
             temp.RHS(1.0);
-            temp.addTermX(getVarIndex_2(k, "y", i), 1.0);
+            temp.addTermX(getVarIndex_2(k, hY, i), 1.0);
         }
         C_XY[k].emplace_back(temp);
     }
@@ -377,12 +380,12 @@ void KAdaptableInfo_BB::makeConsY(unsigned int l) {
         double nomProfit = 0.0;
         double nomCost = 0.0;
         temp.clear();
-        temp.rowname("OBJ_CONSTRAINT(" + std::to_string(k) + ")");
+        temp.rowname(modelName("OBJ_CONSTRAINT", k));
         temp.sign('G');
         temp.RHS(0.0);
-        temp.addTermX(getVarIndex_1("O", 0), 1);
+        temp.addTermX(getVarIndex_1(hO, 0), 1);
         for (int i = 0; i <= data.N-1; ++i) if (data.profit[i] != 0.0) {
-            temp.addTermProduct(getVarIndex_2(k, "y", i), data.phi[0].size() + i);
+            temp.addTermProduct(getVarIndex_2(k, hY, i), data.phi[0].size() + i);
             // temp.addTermX(getVarIndex_2(k, "z", i), -0.1);
             // temp.addTermProduct(getVarIndex_1("w", i), data.phi[0].size() + data.N + i, -1.0);
             nomProfit += data.profit[i];
@@ -391,27 +394,27 @@ void KAdaptableInfo_BB::makeConsY(unsigned int l) {
         if(USE_DRO){
             // std::cout << nomProfit << std::endl;
             // std::cout << nomCost << std::endl;
-            temp.addTermProduct(getVarIndex_1("psi", 0), data.phi[0].size() + (1+CSTR_UNC)*data.N, 1.0);
-            temp.addTermX(getVarIndex_1("psi", 0), -data.dro_size*nomProfit/sqrt(data.N));
+            temp.addTermProduct(getVarIndex_1(hPsi, 0), data.phi[0].size() + (1+CSTR_UNC)*data.N, 1.0);
+            temp.addTermX(getVarIndex_1(hPsi, 0), -data.dro_size*nomProfit/sqrt(data.N));
             
             if(CSTR_UNC){
-                temp.addTermProduct(getVarIndex_1("psi", 1), data.phi[0].size() + (1+CSTR_UNC)*data.N + 1, 1.0);
-                temp.addTermX(getVarIndex_1("psi", 1), -data.dro_size*nomCost/sqrt(data.N));
+                temp.addTermProduct(getVarIndex_1(hPsi, 1), data.phi[0].size() + (1+CSTR_UNC)*data.N + 1, 1.0);
+                temp.addTermX(getVarIndex_1(hPsi, 1), -data.dro_size*nomCost/sqrt(data.N));
             }
             
             if(USE_PAIR){
                 for (int i = 0; i <= data.N-2; ++i)
                 {
-                    temp.addTermProduct(getVarIndex_1("psi", i + 1 + CSTR_UNC), data.phi[0].size() + (1+CSTR_UNC)*(data.N + 1) + i, 1.0);
-                    temp.addTermX(getVarIndex_1("psi", i + 1 + CSTR_UNC), -0.15/2*(data.profit[i]+data.profit[i+1]));
+                    temp.addTermProduct(getVarIndex_1(hPsi, i + 1 + CSTR_UNC), data.phi[0].size() + (1+CSTR_UNC)*(data.N + 1) + i, 1.0);
+                    temp.addTermX(getVarIndex_1(hPsi, i + 1 + CSTR_UNC), -0.15/2*(data.profit[i]+data.profit[i+1]));
                     // temp.addTermX(getVarIndex_1("psi", i + 1 + CSTR_UNC), -0.15);
                 }
                 
                 if(CSTR_UNC){
                     for (int i = 0; i <= data.N-2; ++i)
                     {
-                        temp.addTermProduct(getVarIndex_1("psi", i + 1 + CSTR_UNC - USE_PAIR + data.N) , data.phi[0].size() + (2+CSTR_UNC)*data.N + 1 + CSTR_UNC - USE_PAIR + i, 1.0);
-                        temp.addTermX(getVarIndex_1("psi", i + 1 + CSTR_UNC - USE_PAIR + data.N), -0.15/2*(data.cost[i]+data.cost[i+1]));
+                        temp.addTermProduct(getVarIndex_1(hPsi, i + 1 + CSTR_UNC - USE_PAIR + data.N) , data.phi[0].size() + (2+CSTR_UNC)*data.N + 1 + CSTR_UNC - USE_PAIR + i, 1.0);
+                        temp.addTermX(getVarIndex_1(hPsi, i + 1 + CSTR_UNC - USE_PAIR + data.N), -0.15/2*(data.cost[i]+data.cost[i+1]));
                         // temp.addTermX(getVarIndex_1("psi", i + 1 + CSTR_UNC - USE_PAIR + data.N), -0.75);
                     }
                 }
@@ -441,6 +444,7 @@ void KAdaptableInfo_BB::setInstance(const BB& d) {
     makeVars();
     makeConsX();
     makeConsY(0);
+    compileConstraints();
     assert(isConsistentWithDesign());
 }
 
@@ -225,6 +225,7 @@ void KAdaptableInfo_KNP_DD::makeVars() {
 //-----------------------------------------------------------------------------------
 
 void KAdaptableInfo_KNP_DD::makeConsX() {
+	const VarTypeHandle hW = X.getVarTypeHandle("w");
 	ConstraintExpression temp;
 
 	/////////
@@ -235,14 +236,14 @@ void KAdaptableInfo_KNP_DD::makeConsX() {
 	// bounds on w(i)
 	for (int i = 0; i <= data.N-1; ++i) {
 		temp.clear();
-		temp.addTermX(getVarIndex_1("w", i), 1);
+		temp.addTermX(getVarIndex_1(hW, i), 1);
 
-		temp.rowname("LB_w(" + std::to_string(i) + ")");
+		temp.rowname(modelName("LB_w", i));
 		temp.sign('G');
 		temp.RHS(0);
 		B_X.emplace_back(temp);
 
-		temp.rowname("UB_w(" + std::to_string(i) + ")");
+		temp.rowname(modelName("UB_w", i));
 		temp.sign('L');
 		temp.RHS(1);
 		B_X.emplace_back(temp);
@@ -267,6 +268,8 @@ void KAdaptableInfo_KNP_DD::makeConsX() {
 //-----------------------------------------------------------------------------------
 
 void KAdaptableInfo_KNP_DD::makeConsY(unsigned int l) {
+	const VarTypeHandle hO = X.getVarTypeHandle("O"), hW = X.getVarTypeHandle("w"), hPsi = X.getVarTypeHandle("psi");
+	const VarTypeHandle hY = Y.getVarTypeHandle("y");
 	assert(C_XY.size() == B_Y.size());
 	assert(C_XY.size() == C_XYQ.size());
 	assert(numPolicies >= l);
@@ -288,14 +291,14 @@ void KAdaptableInfo_KNP_DD::makeConsY(unsigned int l) {
 		// bounds on y(i)
 		for (int i = 0; i <= data.N-1; ++i) {
 			temp.clear();
-			temp.addTermX(getVarIndex_2(k, "y", i), 1);
+			temp.addTermX(getVarIndex_2(k, hY, i), 1);
 
-			temp.rowname("LB_y(" + std::to_string(i) + "," + std::to_string(k) + ")");
+			temp.rowname(modelName("LB_y", i, k));
 			temp.sign('G');
 			temp.RHS(0);
 			B_Y[k].emplace_back(temp);
 
-			temp.rowname("UB_y(" + std::to_string(i) + "," + std::to_string(k) + ")");
+			temp.rowname(modelName("UB_y", i, k));
 			temp.sign('L');
 			temp.RHS(1);
 			B_Y[k].emplace_back(temp);
@@ -314,11 +317,11 @@ void KAdaptableInfo_KNP_DD::makeConsY(unsigned int l) {
 		// invest early or invest late
 		for (int i = 0; i <= data.N-1; ++i) {
 			temp.clear();
-			temp.rowname("EITHER(" + std::to_string(i) + "," + std::to_string(k) + ")");
+			temp.rowname(modelName("EITHER", i, k));
 			temp.sign('L');
 			temp.RHS(1.0);
-			temp.addTermX(getVarIndex_1("w", i), 1.0);
-			temp.addTermX(getVarIndex_2(k, "y", i), 1.0);
+			temp.addTermX(getVarIndex_1(hW, i), 1.0);
+			temp.addTermX(getVarIndex_2(k, hY, i), 1.0);
 			
 			C_XY[k].emplace_back(temp);
             //temp.print();
@@ -328,21 +331,21 @@ void KAdaptableInfo_KNP_DD::makeConsY(unsigned int l) {
         if(!CSTR_UNC){
             temp.clear();
             for (int i = 0; i <= data.N-1; ++i) if (data.cost[i] != 0.0) {
-                temp.rowname("BUDGET(" + std::to_string(k) + ")");
+                temp.rowname(modelName("BUDGET", k));
                 temp.sign('L');
                 temp.RHS(data.B);
-                temp.addTermX(getVarIndex_1("w", i), data.cost[i]);
-                temp.addTermX(getVarIndex_2(k, "y", i), data.cost[i]);
+                temp.addTermX(getVarIndex_1(hW, i), data.cost[i]);
+                temp.addTermX(getVarIndex_2(k, hY, i), data.cost[i]);
             }
             C_XY[k].emplace_back(temp);
             //temp.print();
             if(USE_FEAS_W){
                 temp.clear();
                 for (int i = 0; i <= data.N-1; ++i) if (data.cost[i] != 0.0) {
-                    temp.rowname("BUDGET_W(" + std::to_string(k) + ")");
+                    temp.rowname(modelName("BUDGET_W", k));
                     temp.sign('L');
                     temp.RHS(data.B);
-                    temp.addTermX(getVarIndex_1("w", i), data.cost[i]);
+                    temp.addTermX(getVarIndex_1(hW, i), data.cost[i]);
                 }
                 C_X.emplace_back(temp);
             }
@@ -363,39 +366,39 @@ void KAdaptableInfo_KNP_DD::makeConsY(unsigned int l) {
         double nomProfit = 0.0;
         double nomCost = 0.0;
 		temp.clear();
-		temp.rowname("OBJ_CONSTRAINT(" + std::to_string(k) + ")");
+		temp.rowname(modelName("OBJ_CONSTRAINT", k));
 		temp.sign('G');
 		temp.RHS(0);
-		temp.addTermX(getVarIndex_1("O", 0), 1);
+		temp.addTermX(getVarIndex_1(hO, 0), 1);
 		for (int i = 0; i <= data.N-1; ++i){
-            temp.addTermProduct(getVarIndex_1("w", i), data.phi[0].size() + i, 1.0);
+            temp.addTermProduct(getVarIndex_1(hW, i), data.phi[0].size() + i, 1.0);
             // temp.addTermX(getVarIndex_1("w", i), -data.profit[i]);
             // C_W[i] = -data.profit[i];
-            temp.addTermProduct(getVarIndex_2(k, "y", i), data.phi[0].size() + i, data.theta);
+            temp.addTermProduct(getVarIndex_2(k, hY, i), data.phi[0].size() + i, data.theta);
             nomProfit += data.profit[i];
             nomCost += data.cost[i];
 		}
         if(USE_DRO){
-            temp.addTermProduct(getVarIndex_1("psi", 0), data.phi[0].size() + (1+CSTR_UNC)*data.N, 1.0);
-            temp.addTermX(getVarIndex_1("psi", 0), -0.15*nomProfit/sqrt(data.N));
+            temp.addTermProduct(getVarIndex_1(hPsi, 0), data.phi[0].size() + (1+CSTR_UNC)*data.N, 1.0);
+            temp.addTermX(getVarIndex_1(hPsi, 0), -0.15*nomProfit/sqrt(data.N));
             
             if(CSTR_UNC){
-                temp.addTermProduct(getVarIndex_1("psi", 1), data.phi[0].size() + (1+CSTR_UNC)*data.N + 1, 1.0);
-                temp.addTermX(getVarIndex_1("psi", 1), -0.15*nomCost/sqrt(data.N));
+                temp.addTermProduct(getVarIndex_1(hPsi, 1), data.phi[0].size() + (1+CSTR_UNC)*data.N + 1, 1.0);
+                temp.addTermX(getVarIndex_1(hPsi, 1), -0.15*nomCost/sqrt(data.N));
             }
             
             if(USE_SINGLE){
                 for (int i = 0; i <= data.N-1; ++i)
                 {
-                    temp.addTermProduct(getVarIndex_1("psi", i + 1 + CSTR_UNC), data.phi[0].size() + (1+CSTR_UNC)*(data.N + 1) + i, 1.0);
-                    temp.addTermX(getVarIndex_1("psi", i + 1 + CSTR_UNC), -0.15*data.profit[i]);
+                    temp.addTermProduct(getVarIndex_1(hPsi, i + 1 + CSTR_UNC), data.phi[0].size() + (1+CSTR_UNC)*(data.N + 1) + i, 1.0);
+                    temp.addTermX(getVarIndex_1(hPsi, i + 1 + CSTR_UNC), -0.15*data.profit[i]);
                 }
                 
                 if(CSTR_UNC){
                     for (int i = 0; i <= data.N-1; ++i)
                     {
-                        temp.addTermProduct(getVarIndex_1("psi", i + 1 + CSTR_UNC + data.N), data.phi[0].size() + (2+CSTR_UNC)*data.N + 1 + CSTR_UNC + i, 1.0);
-                        temp.addTermX(getVarIndex_1("psi", i + 1 + CSTR_UNC + data.N), -0.15*data.cost[i]);
+                        temp.addTermProduct(getVarIndex_1(hPsi, i + 1 + CSTR_UNC + data.N), data.phi[0].size() + (2+CSTR_UNC)*data.N + 1 + CSTR_UNC + i, 1.0);
+                        temp.addTermX(getVarIndex_1(hPsi, i + 1 + CSTR_UNC + data.N), -0.15*data.cost[i]);
                     }
                 }
             }
@@ -408,23 +411,23 @@ void KAdaptableInfo_KNP_DD::makeConsY(unsigned int l) {
 		// budget
         if(CSTR_UNC){
             temp.clear();
-            temp.rowname("BUDGET(" + std::to_string(k) + ")");
+            temp.rowname(modelName("BUDGET", k));
             temp.sign('L');
             temp.RHS(data.B);
             for (int i = 0; i <= data.N-1; ++i){
-                temp.addTermProduct(getVarIndex_1("w", i), data.phi[0].size() + + data.N + i, 1.0);
-                temp.addTermProduct(getVarIndex_2(k, "y", i), data.phi[0].size() + + data.N + i, 1.0);
+                temp.addTermProduct(getVarIndex_1(hW, i), data.phi[0].size() + + data.N + i, 1.0);
+                temp.addTermProduct(getVarIndex_2(k, hY, i), data.phi[0].size() + + data.N + i, 1.0);
             }
             C_XYQ[k].emplace_back(temp);
             
             if(k==0){
                 if(USE_FEAS_W){
                     temp.clear();
-                    temp.rowname("BUDGET_W");
+                    temp.rowname(modelName("BUDGET_W"));
                     temp.sign('L');
                     temp.RHS(data.B);
                     for (int i = 0; i <= data.N-1; ++i){
-                        temp.addTermProduct(getVarIndex_1("w", i), data.phi[0].size() + + data.N + i, 1.0);
+                        temp.addTermProduct(getVarIndex_1(hW, i), data.phi[0].size() + + data.N + i, 1.0);
                     }
                     C_XQ.emplace_back(temp);
                 }
@@ -450,6 +453,7 @@ void KAdaptableInfo_KNP_DD::setInstance(const KNP& d) {
 	makeVars();
 	makeConsX();
 	makeConsY(0);
+	compileConstraints();
 	assert(isConsistentWithDesign());
 }
 
@@ -23,6 +23,10 @@
 
 #include "robustSolver.hpp"
 #include "Constants.h"
+#include "cutPool.hpp"
+#include "lruCache.hpp"
+#include "modelBuilder.hpp"
+#include "modelNames.hpp"
 #include <cassert>
 #include <cmath>
 #include <string>
@@ -33,6 +37,7 @@
 #include <time.h>
 #include <sys/time.h>
 #include <iomanip>
+#include <unordered_map>
 static double get_wall_time(){
     struct timeval time;
     if (gettimeofday(&time,NULL)){
@@ -54,10 +59,14 @@ const double EPS_INFEASIBILITY_X   = 1.E-4;
 static std::vector<double> Q_TEMP;
 static std::vector<double> X_TEMP;
 static int LABEL_TEMP;
-static std::vector<std::pair<double, double> > ZT_VALUES, BOUND_VALUES;
 
 // static global members
-static int NUM_DUMMY_NODES = 0, TX = 0;
+static int NUM_DUMMY_NODES = 0;
+
+// verified (-1) or rejected (violating label) incumbent candidates, keyed on rounded solution + node labels
+static std::unordered_map<std::vector<long long>, int, IntVectorHash> INCUMBENT_CACHE;
+static unsigned long INCUMBENT_CACHE_HITS = 0, INCUMBENT_CACHE_QUERIES = 0;
+
 static double START_TS = 0;
 volatile int TERMINATOR;
 volatile int TERMINATOR_INNER;
@@ -78,7 +87,9 @@ const bool COLLECT_RESULTS       = 1;
 const bool BB_IMPLEMENT_LAZY_CON = 0;
 const bool BNC_BRANCH_ALL_CONSTR = 1;
 const bool BNC_DO_STRONG_BRANCH  = 0;
+const bool BNC_BREAK_SYMMETRY    = 1;
 const bool SEPARATE_FROM_SAMPLES = 1;
+const int  SEPARATION_TOP_M      = 3; // max # of violating scenarios per policy cut off in one cut callback round
 const bool SEPARATE_ALTERNATE    = 0;
 const bool SEPARATE_ALTERNATE_AVG= 0;
 const int  BRANCHING_STRATEGY    = 1;
@@ -94,6 +105,26 @@ const bool SOLVE_RLP_FIRST = 0;
 const bool USE_INFORM_CUT = 0;
 const bool USE_STRE_FEAS_CUT = 0;
 
+// Scenario-clustering primal heuristic (see heurCB_solve_KAdaptability_cuttingPlane)
+const bool   USE_CLUSTER_HEURISTIC   = 1;
+const int    CLUSTER_HEUR_MAX_ITER   = 20;
+const double CLUSTER_HEUR_TIME_LIMIT = 10;     // capped by the time left in the main solve
+const CPXLONG CLUSTER_HEUR_NODE_FREQ  = 200;    // run at most once every .. nodes
+const CPXLONG CLUSTER_HEUR_STALL_NODES = 50;    // ... unless the incumbent did not improve in the last .. nodes
+const double CLUSTER_HEUR_MIN_TIME    = 1;      // skip if less time is left
+
+// Capacity of the (time, incumbent, bound, nodes) trace (see SolverTrace)
+const unsigned int TRACE_CAPACITY = 1024;
+
+// Incumbent verification cache (see incCB_solve_KAdaptability_cuttingPlane)
+const bool   USE_INCUMBENT_CACHE     = 1;
+const double INCUMBENT_CACHE_ROUND   = 1.E-6;
+
+// Cut pool (see cutCB_solve_KAdaptability_cuttingPlane and cutCB_solve_SRO_cuttingPlane)
+const bool          USE_CUT_POOL        = 1;
+const unsigned long CUT_POOL_PURGE_FREQ = 100;
+const unsigned long CUT_POOL_PURGE_AGE  = 1000;
+
 //-----------------------------------------------------------------------------------
 
 #ifndef NDEBUG
@@ -126,7 +157,7 @@ static inline void setCPXoptions(CPXENVptr& env) {
 //-----------------------------------------------------------------------------------
 
 static inline void addVariable(CPXCENVptr env, CPXLPptr lp, const char xctype = 'C', const double lb = 0, const double ub = +CPX_INFBOUND, const double obj = 0, const char *cname = "") {
-    if (CPXXnewcols(env, lp, 1, &obj, &lb, &ub, &xctype, &cname)) {
+    if (CPXXnewcols(env, lp, 1, &obj, &lb, &ub, &xctype, (cname && *cname) ? &cname : NULL)) {
         MYERROR(EXCEPTION_CPXNEWCOLS);
     }
 }
@@ -137,6 +168,131 @@ static inline void addVariable(CPXCENVptr env, CPXLPptr lp, const char xctype =
     addVariable(env, lp, xctype, lb, ub, obj, cname.c_str());
 }
 
+//-----------------------------------------------------------------------------------
+
+// Get the name type(ind1,...) of column linIndex of V, with suffix appended to type (empty if names are not generated)
+static inline std::string columnName(const VarInfo& V, const int linIndex, const std::string& suffix = "") {
+    std::string cname;
+    if (!NAME_MODEL_ELEMENTS) return cname;
+    int ind1, ind2, ind3, ind4, ind5;
+    V.getVarInfo(linIndex, cname, ind1, ind2, ind3, ind4, ind5);
+    cname += suffix;
+    if (ind1 > -1) {
+        cname += "(" + std::to_string(ind1);
+        if (ind2 > -1) cname += "," + std::to_string(ind2);
+        if (ind3 > -1) cname += "," + std::to_string(ind3);
+        if (ind4 > -1) cname += "," + std::to_string(ind4);
+        if (ind5 > -1) cname += "," + std::to_string(ind5);
+        cname += ")";
+    }
+    return cname;
+}
+
+//-----------------------------------------------------------------------------------
+
+// Add constraints to the model, all at once except for those that must be dualized
+// (dualization creates columns, so the rows collected until then are added first)
+static inline void addConstraints(CPXCENVptr env, CPXLPptr lp, ModelBuilder& mb, const std::vector<ConstraintExpression>& cons, UNCSetCPtr U = nullptr, const bool reformulate = false, const std::vector<double>& q = {}) {
+    for (const auto& con: cons) {
+        if (!reformulate || (!con.existBilinearTerms() && !con.existConstQTerms())) {
+            mb.addRow(con, q);
+        }
+        else {
+            if (mb.flushRows(env, lp)) MYERROR(EXCEPTION_CPXNEWROWS);
+            con.addToCplex(env, lp, U, reformulate, q);
+        }
+    }
+    if (mb.flushRows(env, lp)) MYERROR(EXCEPTION_CPXNEWROWS);
+}
+
+//-----------------------------------------------------------------------------------
+// INDICATOR-CONSTRAINT SEPARATION MILP (SEPARATION_STRATEGY 4)
+//
+// max { tau : q in U, sum(j, z_jk) = 1, z_jk => [violation of constraint j of policy k] >= tau }
+// is built once per K and revision of the uncertainty set, in its own environment.
+// Only the indicator constraints, which depend on x, are replaced between calls.
+struct IndicatorSeparationMILP {
+    CPXENVptr env = NULL;
+    CPXLPptr  lp  = NULL;
+
+    /** K and revision of the uncertainty set for which lp was built */
+    unsigned int K = 0;
+    unsigned long revision = 0;
+
+    /** zIndex[k][j] = column of z_jk */
+    std::vector<std::vector<CPXDIM> > zIndex;
+
+    /** zRow[k] = row sum(j, z_jk) = 1 (-1 if policy k has no uncertain constraints) */
+    std::vector<CPXDIM> zRow;
+
+    /** (tau, q) found in the previous call (used as MIP start) */
+    std::vector<double> lastQ;
+
+    /** Workspaces reused across calls (uncertain constraints of a policy, linear portion of an indicator constraint) */
+    RowBatch rows;
+    std::vector<CPXDIM> linind;
+    std::vector<double> linval;
+
+    inline void freeProb() {
+        if (lp) CPXXfreeprob(env, &lp);
+        lp = NULL;
+        K = 0;
+        revision = 0;
+        zIndex.clear();
+        zRow.clear();
+        lastQ.clear();
+    }
+
+    ~IndicatorSeparationMILP() {
+        freeProb();
+        if (env) CPXXcloseCPLEX(&env);
+    }
+};
+static IndicatorSeparationMILP SEP_MILP;
+
+//-----------------------------------------------------------------------------------
+// RESTRICTED MODEL OF THE SCENARIO-CLUSTERING HEURISTIC (see solve_ClusteredScSRO)
+//
+// The scenario-independent part (1st-stage and deterministic 2nd-stage constraints) is built
+// once per call of solve_KAdaptability, in its own environment. Only the scenario constraints,
+// which depend on the clustering, are replaced between calls.
+struct ClusterHeuristicModel {
+    CPXENVptr env = NULL;
+    CPXLPptr  lp  = NULL;
+
+    /** K for which lp was built */
+    unsigned int K = 0;
+
+    /** # of columns and rows of the scenario-independent part */
+    CPXDIM numCols = 0;
+    CPXDIM numRows = 0;
+
+    /** Schedule: # of samples and node count at the last run, best incumbent and node count at its last improvement */
+    unsigned int numSamples = 0;
+    CPXLONG lastRunNode = -1;
+    CPXLONG lastImprovementNode = 0;
+    double lastIncumbent = +std::numeric_limits<double>::max();
+
+    inline void freeProb() {
+        if (lp) CPXXfreeprob(env, &lp);
+        lp = NULL;
+        K = 0;
+        numCols = numRows = 0;
+        numSamples = 0;
+        lastRunNode = -1;
+        lastImprovementNode = 0;
+        lastIncumbent = +std::numeric_limits<double>::max();
+    }
+
+    ~ClusterHeuristicModel() {
+        freeProb();
+        if (env) CPXXcloseCPLEX(&env);
+    }
+};
+static ClusterHeuristicModel CLUSTER_HEUR;
+
+//-----------------------------------------------------------------------------------
+
 static inline void fixVariable(CPXCENVptr env, CPXLPptr lp, const int varIndex, const double val) {
     char lu = 'B';
     CPXXtightenbds(env, lp, 1, &varIndex, &lu, &val);
@@ -144,23 +300,31 @@ static inline void fixVariable(CPXCENVptr env, CPXLPptr lp, const int varIndex,
 
 //-----------------------------------------------------------------------------------
 
-static inline std::pair<double, bool> checkViol(CPXCENVptr env, void *cbdata, int wherefrom, const double rhs, const char sense, const std::vector<int>& cutind, const std::vector<double>& cutval) {
+// Find the row of a batch that is most violated by the node solution of a callback
+// Returns (violation, row) of the first row attaining the maximum, (-Inf, -1) if the batch is empty
+static inline std::pair<double, CPXDIM> mostViolatedRow(CPXCENVptr env, void *cbdata, int wherefrom, const RowBatch& rows) {
 
-    // get node solution
+    // get node solution (buffer is reused; callbacks run on a single thread)
+    static std::vector<double> x;
     CPXCLPptr lp = NULL; CPXXgetcallbacklp(env, cbdata, wherefrom, &lp);
     CPXDIM numcols = CPXXgetnumcols(env, lp);
-    std::vector<double> x(numcols); CPXXgetcallbacknodex(env, cbdata, wherefrom, &x[0], 0, numcols - 1);
+    x.resize(numcols); CPXXgetcallbacknodex(env, cbdata, wherefrom, x.data(), 0, numcols - 1);
 
-    // compute left-hand side
-    double lhs = 0;
-    for (unsigned int i = 0; i < cutind.size(); i++) {
-        lhs += x[cutind[i]] * cutval[i];
-    }
+    std::pair<double, CPXDIM> best(-std::numeric_limits<double>::max(), -1);
+    for (CPXDIM i = 0; i < rows.rcnt; i++) {
 
-    // compute violation
-    double viol = (lhs - rhs) * ((sense == 'G') ? -1.0 : +1.0);
+        // compute left-hand side
+        double lhs = 0;
+        for (CPXNNZ j = rows.rowBegin(i), jlim = rows.rowEnd(i); j < jlim; j++) {
+            lhs += x[rows.rmatind[j]] * rows.rmatval[j];
+        }
+
+        // compute violation
+        const double viol = (lhs - rows.rhs[i]) * ((rows.sense[i] == 'G') ? -1.0 : +1.0);
+        if (viol > best.first) best = std::make_pair(viol, i);
+    }
 
-    return std::make_pair(viol, ((std::trunc(1.E+6 * viol) / 1.E+6) >= -1.E-8));
+    return best;
 }
 
 //-----------------------------------------------------------------------------------
@@ -197,6 +361,80 @@ static inline std::vector<std::vector<int> > generatePTuples(int startInd, int l
     return PTuples;
 }
 
+//-----------------------------------------------------------------------------------
+// LAZY ENUMERATION OF P-TUPLES (c_1,...,c_P), c_k IN {0,...,bound[k].size()-1}, WITH BOUND-BASED PRUNING
+//
+// bound[k][c] is an upper bound on the value of any tuple with c_k = c, so that
+// min_k bound[k][c_k] bounds the value of the tuple (c_1,...,c_P). Tuples whose
+// bound does not exceed the threshold passed to next() are skipped. Indices are
+// visited in order of decreasing bound, so that whole subtrees can be skipped
+// as soon as the bound at some position drops below the threshold.
+class PTupleEnumerator {
+private:
+    const std::vector<std::vector<double> >& bound;
+
+    /** order[k] = indices at position k, sorted by decreasing bound */
+    std::vector<std::vector<int> > order;
+
+    /** current position in order[k] */
+    std::vector<unsigned int> pos;
+
+    /** prefixBound[k] = min_{j <= k} bound of the current index at position j */
+    std::vector<double> prefixBound;
+
+    bool started = false;
+
+public:
+    PTupleEnumerator(const std::vector<std::vector<double> >& arg_bound) : bound(arg_bound), order(arg_bound.size()), pos(arg_bound.size(), 0), prefixBound(arg_bound.size(), 0) {
+        assert(!bound.empty());
+        for (unsigned int k = 0; k < bound.size(); k++) {
+            order[k].resize(bound[k].size());
+            std::iota(order[k].begin(), order[k].end(), 0);
+            std::stable_sort(order[k].begin(), order[k].end(), [&](const int a, const int b) { return bound[k][a] > bound[k][b]; });
+        }
+    }
+
+    /**
+     * Get the next tuple whose bound exceeds the threshold
+     * @param  tuple     the tuple is returned here
+     * @param  threshold tuples with bound <= threshold are skipped
+     * @return           false if there are no more such tuples
+     */
+    inline bool next(std::vector<int>& tuple, const double threshold) {
+        const int P = (int)bound.size();
+        int k;
+        if (!started) {
+            started = true;
+            k = 0;
+            pos[0] = 0;
+        }
+        else {
+            k = P - 1;
+            pos[k]++;
+        }
+
+        while (k >= 0) {
+            if (pos[k] < order[k].size()) {
+                const double b = std::min((k ? prefixBound[k-1] : +std::numeric_limits<double>::max()), bound[k][order[k][pos[k]]]);
+                if (b > threshold) {
+                    prefixBound[k] = b;
+                    if (k == P - 1) {
+                        tuple.resize(P);
+                        for (int j = 0; j < P; j++) tuple[j] = order[j][pos[j]];
+                        return true;
+                    }
+                    pos[++k] = 0;
+                    continue;
+                }
+            }
+            // the remaining indices at position k cannot do better than the current one
+            if (--k >= 0) pos[k]++;
+        }
+
+        return false;
+    }
+};
+
 //-----------------------------------------------------------------------------------
 
 static inline void write(std::ostream& out, std::string N, unsigned int K, std::string seed, std::string status, double final_objval, double total_solution_time, double final_gap) {
@@ -347,6 +585,14 @@ unsigned int KAdaptableSolver::getNumPolicies(const std::vector<double>& x) cons
 
 //-----------------------------------------------------------------------------------
 
+int KAdaptableSolver::getPolicyOfColumn(const int j) const {
+    assert(j >= 0);
+    if (j < pInfo->getNumFirstStage()) return -1;
+    return (j - pInfo->getNumFirstStage()) / pInfo->getNumSecondStage();
+}
+
+//-----------------------------------------------------------------------------------
+
 void KAdaptableSolver::resizeX(std::vector<double>& x, const unsigned int K) const {
     assert(pInfo);
 
@@ -431,26 +677,16 @@ void KAdaptableSolver::updateX(CPXCENVptr env, CPXLPptr lp) const {
     auto& X   = pInfo->getVarsX();
     auto& C_X = pInfo->getConstraintsX();
 
+    ModelBuilder mb(NAME_MODEL_ELEMENTS);
+
     // define variables
     for (int i = 0; i < X.getTotalVarSize(); i++) if (!X.isUndefVar(i)) {
-        std::string cname;
-        int ind1, ind2, ind3, ind4, ind5;
-        X.getVarInfo(i, cname, ind1, ind2, ind3, ind4, ind5);
-        if (ind1 > -1) {
-            cname += "(" + std::to_string(ind1);
-            if (ind2 > -1) cname += "," + std::to_string(ind2);
-            if (ind3 > -1) cname += "," + std::to_string(ind3);
-            if (ind4 > -1) cname += "," + std::to_string(ind4);
-            if (ind5 > -1) cname += "," + std::to_string(ind5);
-            cname += ")";
-        }
-        addVariable(env, lp, X.getVarColType(i), X.getVarLB(i), X.getVarUB(i), X.getVarObjCoeff(i), cname);
+        mb.addCol(X.getVarColType(i), X.getVarLB(i), X.getVarUB(i), X.getVarObjCoeff(i), columnName(X, i));
     }
+    if (mb.flushCols(env, lp)) MYERROR(EXCEPTION_CPXNEWCOLS);
 
     // define constraints
-    for (const auto& con: C_X) {
-        con.addToCplex(env, lp);
-    }
+    addConstraints(env, lp, mb, C_X);
 }
 
 //-----------------------------------------------------------------------------------
@@ -467,19 +703,14 @@ void KAdaptableSolver::updateXQ(CPXCENVptr env, CPXLPptr lp, const std::vector<d
 
     // define constraints
     if (lazy) {
-        CPXDIM rcnt = 0;
-        CPXNNZ nzcnt = 0;
-        std::vector<double> rhs;
-        std::vector<char> sense;
-        std::vector<CPXNNZ> rmatbeg;
-        std::vector<CPXDIM> rmatind;
-        std::vector<double> rmatval;
-        getXQ_fixedQ(q, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
+        static RowBatch rows;
+        getXQ_fixedQ(q, rows);
 
-        CPXXaddlazyconstraints(env, lp, rcnt, nzcnt, &rhs[0], &sense[0], &rmatbeg[0], &rmatind[0], &rmatval[0], NULL);
+        CPXXaddlazyconstraints(env, lp, rows.rcnt, rows.nzcnt, rows.rhs.data(), rows.sense.data(), rows.rmatbeg.data(), rows.rmatind.data(), rows.rmatval.data(), NULL);
     }
-    else for (const auto& con: C_XQ) {
-        con.addToCplex(env, lp, &pInfo->getUncSet(), reformulate, q);
+    else {
+        ModelBuilder mb(NAME_MODEL_ELEMENTS);
+        addConstraints(env, lp, mb, C_XQ, &pInfo->getUncSet(), reformulate, q);
     }
 }
 
@@ -495,27 +726,17 @@ void KAdaptableSolver::updateY(CPXCENVptr env, CPXLPptr lp, const unsigned int k
     auto& Y    = pInfo->getVarsY();
     auto& C_XY = pInfo->getConstraintsXY()[k];
 
+    ModelBuilder mb(NAME_MODEL_ELEMENTS);
+
     // define variables
+    const std::string suffix = NAME_MODEL_ELEMENTS ? "_" + std::to_string(k) : std::string();
     for (int i = 0; i < Y.getTotalVarSize(); i++) if (!Y.isUndefVar(i)) {
-        std::string cname;
-        int ind1, ind2, ind3, ind4, ind5;
-        Y.getVarInfo(i, cname, ind1, ind2, ind3, ind4, ind5);
-        cname += "_" + std::to_string(k);
-        if (ind1 > -1) {
-            cname += "(" + std::to_string(ind1);
-            if (ind2 > -1) cname += "," + std::to_string(ind2);
-            if (ind3 > -1) cname += "," + std::to_string(ind3);
-            if (ind4 > -1) cname += "," + std::to_string(ind4);
-            if (ind5 > -1) cname += "," + std::to_string(ind5);
-            cname += ")";
-        }
-        addVariable(env, lp, Y.getVarColType(i), Y.getVarLB(i), Y.getVarUB(i), Y.getVarObjCoeff(i), cname);
+        mb.addCol(Y.getVarColType(i), Y.getVarLB(i), Y.getVarUB(i), Y.getVarObjCoeff(i), columnName(Y, i, suffix));
     }
+    if (mb.flushCols(env, lp)) MYERROR(EXCEPTION_CPXNEWCOLS);
 
     // define constraints
-    for (const auto& con: C_XY) {
-        con.addToCplex(env, lp);
-    }
+    addConstraints(env, lp, mb, C_XY);
 }
 
 //-----------------------------------------------------------------------------------
@@ -535,111 +756,62 @@ void KAdaptableSolver::updateYQ(CPXCENVptr env, CPXLPptr lp, const unsigned int
 
     // define constraints
     if (lazy) {
-        CPXDIM rcnt = 0;
-        CPXNNZ nzcnt = 0;
-        std::vector<double> rhs;
-        std::vector<char> sense;
-        std::vector<CPXNNZ> rmatbeg;
-        std::vector<CPXDIM> rmatind;
-        std::vector<double> rmatval;
-        getYQ_fixedQ(k, q, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
+        static RowBatch rows;
+        getYQ_fixedQ(k, q, rows);
 
-        CPXXaddlazyconstraints(env, lp, rcnt, nzcnt, &rhs[0], &sense[0], &rmatbeg[0], &rmatind[0], &rmatval[0], NULL);
+        CPXXaddlazyconstraints(env, lp, rows.rcnt, rows.nzcnt, rows.rhs.data(), rows.sense.data(), rows.rmatbeg.data(), rows.rmatind.data(), rows.rmatval.data(), NULL);
     }
-    else for (const auto& con: C_XYQ) {
-        con.addToCplex(env, lp, &pInfo->getUncSet(), reformulate, q);
+    else {
+        ModelBuilder mb(NAME_MODEL_ELEMENTS);
+        addConstraints(env, lp, mb, C_XYQ, &pInfo->getUncSet(), reformulate, q);
     }
 }
 
 //-----------------------------------------------------------------------------------
 
-void KAdaptableSolver::getXQ_fixedQ(const std::vector<double>& q, CPXDIM& rcnt, CPXNNZ& nzcnt, std::vector<double>& rhs, std::vector<char>& sense, std::vector<CPXNNZ>& rmatbeg, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const {
+void KAdaptableSolver::getXQ_fixedQ(const std::vector<double>& q, RowBatch& rows) const {
     assert(pInfo);
 
     // vectors must be of appropriate size
     if ((int)q.size() != MY_SIZE_Q) MYERROR(EXCEPTION_Q);
 
     // initialize members
-    auto& C_XQ = pInfo->getConstraintsXQ();
-    rcnt = 0;
-    nzcnt = 0;
-    rhs.clear();
-    sense.clear();
-    rmatbeg.clear();
-    rmatind.clear();
-    rmatval.clear();
+    auto& C_XQ = pInfo->getBlockXQ();
+    rows.clear();
 
     // Statically add constraints involving uncertain parameters
-    for (const auto& con : C_XQ) {
-        
-        rcnt ++;
-        CPXNNZ nzcnt_p = 0;
-        rhs.emplace_back(0);
-        sense.emplace_back('L');
-        rmatbeg.emplace_back(rmatind.size());
-        std::vector<CPXDIM> indices;
-        std::vector<double> values;
-
-        con.getDeterministicConstraint(q, nzcnt_p, rhs.back(), sense.back(), indices, values);
-
-        nzcnt += nzcnt_p;
-        rmatind.insert(rmatind.end(), indices.begin(), indices.end());
-        rmatval.insert(rmatval.end(), values.begin(), values.end());
-    }
-
-    assert(rhs.size() == rmatbeg.size());
-    assert(rhs.size() == sense.size());
-    assert((CPXDIM)rhs.size() == rcnt);
-    assert(rmatind.size() == rmatval.size());
-    assert((CPXNNZ)rmatind.size() == nzcnt);
+    for (const auto con : C_XQ) {
+        rows.addRow();
+        rows.nzcnt += con.appendDeterministicConstraint(q, rows.rhs.back(), rows.sense.back(), rows.rmatind, rows.rmatval);
+    }
+
+    assert(rows.isConsistent());
 }
 
 //-----------------------------------------------------------------------------------
 
-void KAdaptableSolver::getXQ_fixedX(const std::vector<double>& x, CPXDIM& rcnt, CPXNNZ& nzcnt, std::vector<double>& rhs, std::vector<char>& sense, std::vector<CPXNNZ>& rmatbeg, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const {
+void KAdaptableSolver::getXQ_fixedX(const std::vector<double>& x, RowBatch& rows) const {
     assert(pInfo);
 
     // vectors must be of appropriate size
     if ((int)x.size() < MY_SIZE_X(1)) MYERROR(EXCEPTION_X);
 
     // initialize members
-    auto& C_XQ = pInfo->getConstraintsXQ();
-    rcnt = 0;
-    nzcnt = 0;
-    rhs.clear();
-    sense.clear();
-    rmatbeg.clear();
-    rmatind.clear();
-    rmatval.clear();
+    auto& C_XQ = pInfo->getBlockXQ();
+    rows.clear();
 
     // Statically add constraints involving uncertain parameters
-    for (const auto& con : C_XQ) {
-        
-        rcnt ++;
-        CPXNNZ nzcnt_p = 0;
-        rhs.emplace_back(0);
-        sense.emplace_back('L');
-        rmatbeg.emplace_back(rmatind.size());
-        std::vector<CPXDIM> indices;
-        std::vector<double> values;
-
-        con.getStochasticConstraint(x, nzcnt_p, rhs.back(), sense.back(), indices, values);
-
-        nzcnt += nzcnt_p;
-        rmatind.insert(rmatind.end(), indices.begin(), indices.end());
-        rmatval.insert(rmatval.end(), values.begin(), values.end());
-    }
-
-    assert(rhs.size() == rmatbeg.size());
-    assert(rhs.size() == sense.size());
-    assert((CPXDIM)rhs.size() == rcnt);
-    assert(rmatind.size() == rmatval.size());
-    assert((CPXNNZ)rmatind.size() == nzcnt);
+    for (const auto con : C_XQ) {
+        rows.addRow();
+        rows.nzcnt += con.appendStochasticConstraint(x, rows.rhs.back(), rows.sense.back(), rows.rmatind, rows.rmatval);
+    }
+
+    assert(rows.isConsistent());
 }
 
 //-----------------------------------------------------------------------------------
 
-void KAdaptableSolver::getYQ_fixedQ(const unsigned int k, const std::vector<double>& q, CPXDIM& rcnt, CPXNNZ& nzcnt, std::vector<double>& rhs, std::vector<char>& sense, std::vector<CPXNNZ>& rmatbeg, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const {
+void KAdaptableSolver::getYQ_fixedQ(const unsigned int k, const std::vector<double>& q, RowBatch& rows, const bool append) const {
     assert(pInfo);
 
     // vectors must be of appropriate size
@@ -647,38 +819,16 @@ void KAdaptableSolver::getYQ_fixedQ(const unsigned int k, const std::vector<doub
     if ((int)q.size() != MY_SIZE_Q) MYERROR(EXCEPTION_Q);
 
     // initialize members
-    auto& C_XYQ = pInfo->getConstraintsXYQ()[k];
-    rcnt = 0;
-    nzcnt = 0;
-    rhs.clear();
-    sense.clear();
-    rmatbeg.clear();
-    rmatind.clear();
-    rmatval.clear();
+    auto& C_XYQ = pInfo->getBlockXYQ()[k];
+    if (!append) rows.clear();
 
     // Statically add constraints involving uncertain parameters
-    for (const auto& con : C_XYQ) {
-        
-        rcnt ++;
-        CPXNNZ nzcnt_p = 0;
-        rhs.emplace_back(0);
-        sense.emplace_back('L');
-        rmatbeg.emplace_back(rmatind.size());
-        std::vector<CPXDIM> indices;
-        std::vector<double> values;
-
-        con.getDeterministicConstraint(q, nzcnt_p, rhs.back(), sense.back(), indices, values);
-
-        nzcnt += nzcnt_p;
-        rmatind.insert(rmatind.end(), indices.begin(), indices.end());
-        rmatval.insert(rmatval.end(), values.begin(), values.end());
-    }
-
-    assert(rhs.size() == rmatbeg.size());
-    assert(rhs.size() == sense.size());
-    assert((CPXDIM)rhs.size() == rcnt);
-    assert(rmatind.size() == rmatval.size());
-    assert((CPXNNZ)rmatind.size() == nzcnt);
+    for (const auto con : C_XYQ) {
+        rows.addRow();
+        rows.nzcnt += con.appendDeterministicConstraint(q, rows.rhs.back(), rows.sense.back(), rows.rmatind, rows.rmatval);
+    }
+
+    assert(rows.isConsistent());
 }
 
 //-----------------------------------------------------------------------------------
@@ -691,12 +841,8 @@ void KAdaptableSolver::getSingleYQ_fixedQ(const unsigned int k, const uint label
     if ((int)q.size() != MY_SIZE_Q) MYERROR(EXCEPTION_Q);
     if (labelCstr >= pInfo->getConstraintsXYQ()[k].size()) MYERROR(EXCEPTION_C);
     
-    // get constraint
-    auto con = pInfo->getConstraintsXYQ()[k][labelCstr];
-    // initialize members
-    nzcnt = 0;
-    rmatind.clear();
-    rmatval.clear();
+    // get constraint (row view, no copy)
+    const auto con = pInfo->getBlockXYQ()[k][labelCstr];
 
     con.getDeterministicConstraint(q, nzcnt, rhs, sense, rmatind, rmatval);
 
@@ -704,7 +850,7 @@ void KAdaptableSolver::getSingleYQ_fixedQ(const unsigned int k, const uint label
 
 //-----------------------------------------------------------------------------------
 
-void KAdaptableSolver::getYQ_fixedX(const unsigned int k, const std::vector<double>& x, CPXDIM& rcnt, CPXNNZ& nzcnt, std::vector<double>& rhs, std::vector<char>& sense, std::vector<CPXNNZ>& rmatbeg, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval) const {
+void KAdaptableSolver::getYQ_fixedX(const unsigned int k, const std::vector<double>& x, RowBatch& rows) const {
     assert(pInfo);
 
     // vectors must be of appropriate size
@@ -712,42 +858,20 @@ void KAdaptableSolver::getYQ_fixedX(const unsigned int k, const std::vector<doub
     if (x.size() < MY_SIZE_X(k+1)) MYERROR(EXCEPTION_X);
 
     // initialize members
-    auto& C_XYQ = pInfo->getConstraintsXYQ()[k];
-    rcnt = 0;
-    nzcnt = 0;
-    rhs.clear();
-    sense.clear();
-    rmatbeg.clear();
-    rmatind.clear();
-    rmatval.clear();
+    auto& C_XYQ = pInfo->getBlockXYQ()[k];
+    rows.clear();
 
     // Statically add constraints involving uncertain parameters
-    for (const auto& con : C_XYQ) {
-        
-        rcnt ++;
-        CPXNNZ nzcnt_p = 0;
-        rhs.emplace_back(0);
-        sense.emplace_back('L');
-        rmatbeg.emplace_back(rmatind.size());
-        std::vector<CPXDIM> indices;
-        std::vector<double> values;
-
-        con.getStochasticConstraint(x, nzcnt_p, rhs.back(), sense.back(), indices, values);
-
-        nzcnt += nzcnt_p;
-        rmatind.insert(rmatind.end(), indices.begin(), indices.end());
-        rmatval.insert(rmatval.end(), values.begin(), values.end());
-    }
-
-    assert(rhs.size() == rmatbeg.size());
-    assert(rhs.size() == sense.size());
-    assert((CPXDIM)rhs.size() == rcnt);
-    assert(rmatind.size() == rmatval.size());
-    assert((CPXNNZ)rmatind.size() == nzcnt);
+    for (const auto con : C_XYQ) {
+        rows.addRow();
+        rows.nzcnt += con.appendStochasticConstraint(x, rows.rhs.back(), rows.sense.back(), rows.rmatind, rows.rmatval);
+    }
+
+    assert(rows.isConsistent());
 }
 
 //-----------------------------------------------------------------------------------
-void KAdaptableSolver::getRobustYQ_fixedQ(const std::vector<double>& q, CPXDIM& rcnt, CPXNNZ& nzcnt, std::vector<double>& rhs, std::vector<char>& sense, std::vector<CPXNNZ>& rmatbeg, std::vector<CPXDIM>& rmatind, std::vector<double>& rmatval)
+void KAdaptableSolver::getRobustYQ_fixedQ(const std::vector<double>& q, RowBatch& rows)
 {
     assert(pInfo);
 
@@ -758,13 +882,7 @@ void KAdaptableSolver::getRobustYQ_fixedQ(const std::vector<double>& q, CPXDIM&
     
 //    // initialize members
 //    auto& C_XYQ = pInfo->getConstraintsXYQ()[0];
-    rcnt = 0;
-    nzcnt = 0;
-    rhs.clear();
-    sense.clear();
-    rmatbeg.clear();
-    rmatind.clear();
-    rmatval.clear();
+    rows.clear();
 //
 //    // Statically add constraints involving uncertain parameters
 //    for (const auto& con : C_XYQ) {
@@ -806,28 +924,8 @@ void KAdaptableSolver::getRobustYQ_fixedQ(const std::vector<double>& q, CPXDIM&
 //        assert(qTermsInProduct);
         int status = solve_YQRobust_cuttingplane(q);
         if(!status){
-            for(auto qtemp : inner_samples){
-                CPXDIM rcnt_p = 0;
-                CPXNNZ nzcnt_p = 0;
-                std::vector<double> trueRhs;
-                std::vector<char> trueSense;
-                std::vector<CPXNNZ> begins;
-                std::vector<CPXDIM> indices;
-                std::vector<double> values;
-                
-                getYQ_fixedQ(0, qtemp, rcnt_p, nzcnt_p, trueRhs, trueSense, begins, indices, values);
-                
-                nzcnt += nzcnt_p;
-                rcnt += rcnt_p;
-                rhs.insert(rhs.end(), trueRhs.begin(), trueRhs.end());
-                sense.insert(sense.end(), trueSense.begin(), trueSense.end());
-                
-                std::vector<int> pos(begins.size(), rmatind.size());
-                std::transform(begins.begin(), begins.end(), pos.begin(), begins.begin(), std::plus<int>());
-                rmatbeg.insert(rmatbeg.end(), begins.begin(), begins.end());
-                
-                rmatind.insert(rmatind.end(), indices.begin(), indices.end());
-                rmatval.insert(rmatval.end(), values.begin(), values.end());
+            for(const auto& qtemp : inner_samples){
+                getYQ_fixedQ(0, qtemp, rows, true);
             }
         }
         else{
@@ -836,11 +934,7 @@ void KAdaptableSolver::getRobustYQ_fixedQ(const std::vector<double>& q, CPXDIM&
         }
 //    }
 
-    assert(rhs.size() == rmatbeg.size());
-    assert(rhs.size() == sense.size());
-    assert((CPXDIM)rhs.size() == rcnt);
-    assert(rmatind.size() == rmatval.size());
-    assert((CPXNNZ)rmatind.size() == nzcnt);
+    assert(rows.isConsistent());
     
     pInfo->resetXiBar();
     return;
@@ -1046,34 +1140,12 @@ void KAdaptableSolver::feasibleW(CPXENVptr env, CPXLPptr lp) const
     // step 2: add variables into the environment
     auto& X   = pInfo->getVarsX();
     for (int i = 0; i < X.getTotalVarSize(); i++) if (!X.isUndefVar(i)) {
-        std::string cname;
-        int ind1, ind2, ind3, ind4, ind5;
-        X.getVarInfo(i, cname, ind1, ind2, ind3, ind4, ind5);
-        if (ind1 > -1) {
-            cname += "(" + std::to_string(ind1);
-            if (ind2 > -1) cname += "," + std::to_string(ind2);
-            if (ind3 > -1) cname += "," + std::to_string(ind3);
-            if (ind4 > -1) cname += "," + std::to_string(ind4);
-            if (ind5 > -1) cname += "," + std::to_string(ind5);
-            cname += ")";
-        }
-        addVariable(env_, lp_, X.getVarColType(i), X.getVarLB(i), X.getVarUB(i), 0.0, cname);
+        addVariable(env_, lp_, X.getVarColType(i), X.getVarLB(i), X.getVarUB(i), 0.0, columnName(X, i));
     }
     
     auto& Y    = pInfo->getVarsY();
     for (int i = 0; i < Y.getTotalVarSize(); i++) if (!Y.isUndefVar(i)) {
-        std::string cname;
-        int ind1, ind2, ind3, ind4, ind5;
-        Y.getVarInfo(i, cname, ind1, ind2, ind3, ind4, ind5);
-        if (ind1 > -1) {
-            cname += "(" + std::to_string(ind1);
-            if (ind2 > -1) cname += "," + std::to_string(ind2);
-            if (ind3 > -1) cname += "," + std::to_string(ind3);
-            if (ind4 > -1) cname += "," + std::to_string(ind4);
-            if (ind5 > -1) cname += "," + std::to_string(ind5);
-            cname += ")";
-        }
-        addVariable(env_, lp_, Y.getVarColType(i), Y.getVarLB(i), Y.getVarUB(i), 0.0, cname);
+        addVariable(env_, lp_, Y.getVarColType(i), Y.getVarLB(i), Y.getVarUB(i), 0.0, columnName(Y, i));
     }
     
     // step 3: iterate through all constraint and get the projection to the w space
@@ -1346,24 +1418,18 @@ double KAdaptableSolver::getWorstCase(const std::vector<double>& x, const unsign
     if (!feasible_KAdaptability(x, K, q)) return +std::numeric_limits<double>::max();
 
 
-    CPXDIM rcnt = 0;
-    CPXNNZ nzcnt = 0;
+    RowBatch rows;
     int objective_idx = -1;
-    std::vector<double> rhs;
-    std::vector<char> sense;
-    std::vector<CPXNNZ> rmatbeg;
-    std::vector<CPXDIM> rmatind;
-    std::vector<double> rmatval;
 
 
     /////////////////////////////////////////////////////////////////////////
     // NOTE: I'M ASSUMING THAT THE ORIGINAL PROBLEM IS ALWAYS REFORMULATED //
     //       USING AN EPIGRAPHICAL VARIABLE FOR THE OBJECTIVE FUNCTION     //
     /////////////////////////////////////////////////////////////////////////
-    getYQ_fixedQ(0, pInfo->getNominal(), rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
-    for (CPXDIM j = 0; j < rcnt; j++) {
-        auto begin = rmatind.begin() + rmatbeg[j];
-        auto end = rmatind.begin() + ((j+1 == rcnt) ? nzcnt : rmatbeg[j+1]);
+    getYQ_fixedQ(0, pInfo->getNominal(), rows);
+    for (CPXDIM j = 0; j < rows.rcnt; j++) {
+        auto begin = rows.rmatind.begin() + rows.rmatbeg[j];
+        auto end = rows.rmatind.begin() + ((j+1 == rows.rcnt) ? rows.nzcnt : rows.rmatbeg[j+1]);
         if (std::find(begin, end, 0) != end) {
             objective_idx = j;
             break;
@@ -1395,7 +1461,7 @@ double KAdaptableSolver::getWorstCase(const std::vector<double>& x, const unsign
     auto& U = pInfo->getUncSet();
     const auto PTuples = generatePTuples(0, 1, K);
     std::vector<double> max_q(1, -std::numeric_limits<double>::max());
-    bool single_constraint = (rcnt == 2);
+    bool single_constraint = (rows.rcnt == 2);
 
 
     // tuple[k] denotes whether policy k is feasible in the current partition
@@ -1425,20 +1491,20 @@ double KAdaptableSolver::getWorstCase(const std::vector<double>& x, const unsign
         for (unsigned int k = 0; k < K; ++k) {
 
             // get all uncertain constraints in policy k for fixed x
-            getYQ_fixedX(k, x, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
+            getYQ_fixedX(k, x, rows);
 
             // only for infeasible policies: sum(j, z_jk) = 1
-            ConstraintExpression zConstraint("z(" + std::to_string(k) + ")");
+            ConstraintExpression zConstraint(modelName("z", k));
             zConstraint.sign('E');
             zConstraint.RHS(1);
 
-            for (CPXDIM j = 0; j < rcnt; j++) {
-                assert(sense[j] == 'G' || sense[j] == 'L');
-                CPXNNZ ilim = (j+1 == rcnt) ? nzcnt : rmatbeg[j+1];
-                double linrhs = rhs[j];
-                char linsense = sense[j];
-                std::vector<CPXDIM> linind(rmatind.begin() + rmatbeg[j], rmatind.begin() + ilim);
-                std::vector<double> linval(rmatval.begin() + rmatbeg[j], rmatval.begin() + ilim);
+            for (CPXDIM j = 0; j < rows.rcnt; j++) {
+                assert(rows.sense[j] == 'G' || rows.sense[j] == 'L');
+                CPXNNZ ilim = (j+1 == rows.rcnt) ? rows.nzcnt : rows.rmatbeg[j+1];
+                double linrhs = rows.rhs[j];
+                char linsense = rows.sense[j];
+                std::vector<CPXDIM> linind(rows.rmatind.begin() + rows.rmatbeg[j], rows.rmatind.begin() + ilim);
+                std::vector<double> linval(rows.rmatval.begin() + rows.rmatbeg[j], rows.rmatval.begin() + ilim);
                 if (linind.empty()) continue;
 
                 // Policy k must be feasible
@@ -1448,11 +1514,11 @@ double KAdaptableSolver::getWorstCase(const std::vector<double>& x, const unsign
                     // ELSE
                     // add as a regular constraint
                     if (j == objective_idx) {
-                        linsense = (sense[j] == 'G') ? 'L' : 'G';
+                        linsense = (rows.sense[j] == 'G') ? 'L' : 'G';
                         linind.emplace_back(0);
-                        linval.emplace_back((sense[j] == 'G') ? 1 : -1);
+                        linval.emplace_back((rows.sense[j] == 'G') ? 1 : -1);
                     }
-                    CPXXaddrows(env, lp, 0, 1, linind.size(), &linrhs, &linsense, &rmatbeg[0], &linind[0], &linval[0], NULL, NULL);
+                    CPXXaddrows(env, lp, 0, 1, linind.size(), &linrhs, &linsense, rows.rmatbeg.data(), &linind[0], &linval[0], NULL, NULL);
                 }
 
                 // Policy k must be infeasible
@@ -1461,16 +1527,16 @@ double KAdaptableSolver::getWorstCase(const std::vector<double>& x, const unsign
 
                     // z_jk indicates whether constraint j is violated
                     // z_jk => [reversed expression of constraint j in terms of q for fixed x in policy k]
-                    linrhs += ((sense[j] == 'G') ? -1.0 : 1.0)*EPS_INFEASIBILITY_X;
-                    linsense = (sense[j] == 'G') ? 'L' : 'G';
+                    linrhs += ((rows.sense[j] == 'G') ? -1.0 : 1.0)*EPS_INFEASIBILITY_X;
+                    linsense = (rows.sense[j] == 'G') ? 'L' : 'G';
 
                     if (single_constraint) {
-                        CPXXaddrows(env, lp, 0, 1, linind.size(), &linrhs, &linsense, &rmatbeg[0], &linind[0], &linval[0], NULL, NULL);
+                        CPXXaddrows(env, lp, 0, 1, linind.size(), &linrhs, &linsense, rows.rmatbeg.data(), &linind[0], &linval[0], NULL, NULL);
                     }
                     else {
                         // define z_jk
                         const int z_index = ++index;
-                        addVariable(env, lp, 'B', 0, 1, 0, "z(" + std::to_string(j) + "," + std::to_string(k) + ")");
+                        addVariable(env, lp, 'B', 0, 1, 0, modelName("z", j, k));
 
                         // add indicator constraint
                         CPXXaddindconstr(env, lp, z_index, 0, linind.size(), linrhs, linsense, &linind[0], &linval[0], NULL);
@@ -1642,8 +1708,8 @@ bool KAdaptableSolver::feasible_XQ(const std::vector<double>& x, const std::vect
 
     // Check each label
     for (label = 0; label < (int)samples.size(); label++) {
-        for (const auto& con: pInfo->getConstraintsXQ()) {
-            const double viol = getViolation(con, x, samples[label]);
+        for (const auto con: pInfo->getBlockXQ()) {
+            const double viol = con.getViolation(x, samples[label]);
             if (GET_MAX_VIOL) {
                 if (viol > maxViol) {
                     maxViol   = viol;
@@ -1724,27 +1790,34 @@ bool KAdaptableSolver::feasible_YQ(const std::vector<double>& x, const unsigned
         std::vector<ConstraintExpression> CExpr(K);
         unsigned int i;
 
-        // get # of 2nd-stage constraints
-        const auto CI      = pInfo->getConstraintsXYQ()[0].size();
-        const auto PTuples = generatePTuples(0, CI - 1, K);
+        // worst-case violation of each constraint of each policy:
+        // max_q min_k viol_k(q) <= min_k max_q viol_k(q), so these bound the violation of every tuple
+        std::vector<std::vector<double> > bound(K);
+        std::vector<std::vector<std::vector<double> > > boundQ(K);
+        for (i = 0; i < K; ++i) {
+            for (const auto& con : pInfo->getConstraintsXYQ()[i]) {
+                boundQ[i].emplace_back(getViolation(con, &pInfo->getUncSet(), x));
+                bound[i].emplace_back(boundQ[i].back()[0]);
+            }
+        }
 
-        for (const auto& tuple : PTuples) {
+        // enumerate tuples that may still exceed the best violation found (resp. the tolerance)
+        PTupleEnumerator PTuples(bound);
+        std::vector<int> tuple;
+        while (PTuples.next(tuple, GET_MAX_VIOL ? max_q[0] : EPS_INFEASIBILITY_Q)) {
             assert(tuple.size() == K);
-            for (i = 0; i < K; ++i) {
-                if (tuple[i] < (int)pInfo->getConstraintsXYQ()[i].size()) {
+
+            // compute violation (bound is exact for single policies)
+            if (K == 1) {
+                q = boundQ[0][tuple[0]];
+            }
+            else {
+                for (i = 0; i < K; ++i) {
                     CExpr[i] = pInfo->getConstraintsXYQ()[i][tuple[i]];
                 }
-                else {
-                    break;
-                }
+                const KAdaptableExpression KExpr(CExpr, "Check");
+                q = KExpr.evaluate(&pInfo->getUncSet(), pInfo->getUncSet().getNominal(), x);
             }
-            assert(i == K);
-            if (i < K) continue;
-
-            const KAdaptableExpression KExpr(CExpr, "Check");
-            
-            // compute violation
-            q = KExpr.evaluate(&pInfo->getUncSet(), pInfo->getUncSet().getNominal(), x);
             if (GET_MAX_VIOL) {
                 if (q[0] > max_q[0]) {
                     max_q = q;
@@ -1797,45 +1870,39 @@ bool KAdaptableSolver::feasible_YQ(const std::vector<double>& x, const unsigned
         index = CPXXgetnumcols(env, lp) - 1;
 
         // Add constraints maximizing violation
+        RowBatch rows;
         for (unsigned int k = 0; k < K; ++k) {
-            CPXDIM rcnt = 0;
-            CPXNNZ nzcnt = 0;
-            std::vector<double> rhs;
-            std::vector<char> sense;
-            std::vector<CPXNNZ> rmatbeg;
-            std::vector<CPXDIM> rmatind;
-            std::vector<double> rmatval;
 
             // get all uncertain constraints in policy k for fixed x
-            getYQ_fixedX(k, x, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
+            getYQ_fixedX(k, x, rows);
 
             // -tau + sum(j, z_jk * [violation expression in terms of q for fixed x in policy k]) >= 0
-            ConstraintExpression tauConstraint("tau(" + std::to_string(k) + ")");
+            ConstraintExpression tauConstraint(modelName("tau", k));
             tauConstraint.sign('G');
             tauConstraint.RHS(0);
             
             // sum(j, z_jk) = 1
-            ConstraintExpression zConstraint("z(" + std::to_string(k) + ")");
+            ConstraintExpression zConstraint(modelName("z", k));
             zConstraint.sign('E');
             zConstraint.RHS(1);
 
-            for (CPXDIM j = 0; j < rcnt; j++) {
-                assert(sense[j] == 'G' || sense[j] == 'L');
-                const double f = (sense[j] == 'G') ? (-1.0) : (+1.0);
+            for (CPXDIM j = 0; j < rows.rcnt; j++) {
+                assert(rows.sense[j] == 'G' || rows.sense[j] == 'L');
+                const double f = (rows.sense[j] == 'G') ? (-1.0) : (+1.0);
 
                 // define z_jk
-                const std::string z_name = "z(" + std::to_string(j) + "," + std::to_string(k) + ")";
+                const std::string z_name = modelName("z", j, k);
                 const int z_index = ++index;
                 addVariable(env, lp, 'B', 0, 1, 0, z_name);
 
-                for (CPXNNZ i = rmatbeg[j], ilim = ((j+1 == rcnt) ? nzcnt : rmatbeg[j+1]); i < ilim; i++) {
+                for (CPXNNZ i = rows.rowBegin(j), ilim = rows.rowEnd(j); i < ilim; i++) {
                     
                     // lower and upper bounds of q_i
-                    const double qlb = qLB[rmatind[i]];
-                    const double qub = qUB[rmatind[i]];
+                    const double qlb = qLB[rows.rmatind[i]];
+                    const double qub = qUB[rows.rmatind[i]];
 
                     // define bilinear = z_jk * q_i
-                    const std::string bl_name = "BL(" + z_name + ",q(" + std::to_string(rmatind[i]) + "))";
+                    const std::string bl_name = modelName("BL", z_name, modelName("q", rows.rmatind[i]));
                     const int bl_index = ++index;
                     addVariable(env, lp, 'C', qlb, qub, 0, bl_name);
 
@@ -1846,7 +1913,7 @@ bool KAdaptableSolver::feasible_YQ(const std::vector<double>& x, const unsigned
                     bl.clear();
                     bl.sign('G');
                     bl.RHS(0);
-                    bl.rowname(bl_name + "_l1");
+                    bl.rowname(modelNameSuffix(bl_name, "_l1"));
                     bl.addTermX(bl_index, 1.0);
                     if (qlb != 0.0) bl.addTermX(z_index, -qlb);
                     bl.addToCplex(env, lp);
@@ -1855,7 +1922,7 @@ bool KAdaptableSolver::feasible_YQ(const std::vector<double>& x, const unsigned
                     bl.clear();
                     bl.sign('L');
                     bl.RHS(0);
-                    bl.rowname(bl_name + "_u1");
+                    bl.rowname(modelNameSuffix(bl_name, "_u1"));
                     bl.addTermX(bl_index, 1.0);
                     if (qub != 0.0) bl.addTermX(z_index, -qub);
                     bl.addToCplex(env, lp);
@@ -1864,29 +1931,29 @@ bool KAdaptableSolver::feasible_YQ(const std::vector<double>& x, const unsigned
                     bl.clear();
                     bl.sign('G');
                     bl.RHS(-qub);
-                    bl.rowname(bl_name + "_l2");
+                    bl.rowname(modelNameSuffix(bl_name, "_l2"));
                     bl.addTermX(bl_index, 1.0);
                     if (qub != 0.0) bl.addTermX(z_index, -qub);
-                    bl.addTermX(rmatind[i], -1.0);
+                    bl.addTermX(rows.rmatind[i], -1.0);
                     bl.addToCplex(env, lp);
 
                     // over-estimator 1:  bl <= (z_jk * qlb) + q_i - qlb
                     bl.clear();
                     bl.sign('L');
                     bl.RHS(-qlb);
-                    bl.rowname(bl_name + "_u2");
+                    bl.rowname(modelNameSuffix(bl_name, "_u2"));
                     bl.addTermX(bl_index, 1.0);
                     if (qlb != 0.0) bl.addTermX(z_index, -qlb);
-                    bl.addTermX(rmatind[i], -1.0);
+                    bl.addTermX(rows.rmatind[i], -1.0);
                     bl.addToCplex(env, lp);
 
                     // UPDATE original constraints
-                    if (rmatval[i] != 0.0) tauConstraint.addTermX(bl_index, (f * rmatval[i]));
+                    if (rows.rmatval[i] != 0.0) tauConstraint.addTermX(bl_index, (f * rows.rmatval[i]));
                 }
 
                 // UPDATE original constraints
                 zConstraint.addTermX(z_index, 1.0);
-                if (rhs[j] != 0.0) tauConstraint.addTermX(z_index, -(f * rhs[j]));
+                if (rows.rhs[j] != 0.0) tauConstraint.addTermX(z_index, -(f * rows.rhs[j]));
             }
 
             // add constraints only if at least one non-zero was added
@@ -1941,94 +2008,128 @@ bool KAdaptableSolver::feasible_YQ(const std::vector<double>& x, const unsigned
         ///////////////////////////////////////////
 
         int status;
-        CPXENVptr env = NULL;
-        CPXLPptr  lp  = NULL;
-        char b;
-        double bd;
-        int index;
-        
-        UncertaintySet U;
-        if(DECISION_DEPENDENT)
-            U = pInfo->getUncSetK();
-        else
-            U = pInfo->getUncSet();
-
-        // get solver objects from uncertainty set
-        env = U.getENVObject();
-        lp  = U.getLPObject(&status);
-
+        const UncertaintySet& U = DECISION_DEPENDENT ? pInfo->getUncSetK() : pInfo->getUncSet();
+        const CPXDIM numQ = U.getNoOfUncertainParameters();
+
+        // (re)build the MILP only if K or the uncertainty set have changed
+        if (!SEP_MILP.lp || SEP_MILP.K != K || SEP_MILP.revision != U.getRevision()) {
+            SEP_MILP.freeProb();
+            if (!SEP_MILP.env) {
+                SEP_MILP.env = CPXXopenCPLEX(&status);
+                if (!SEP_MILP.env) MYERROR(EXCEPTION_CPXINIT);
+                setCPXoptions(SEP_MILP.env);
+                CPXXsetintparam(SEP_MILP.env, CPXPARAM_Threads, NUM_THREADS);
+            }
+            CPXENVptr env = SEP_MILP.env;
+
+            // get solver object from uncertainty set
+            CPXLPptr lp = U.getLPObject(env, &status);
+            if (status || !lp) MYERROR(EXCEPTION_CPXINIT);
+
+            // convert problem to maximization MILP with objective = [tau]
+            std::vector<CPXDIM> cols(1 + numQ);
+            std::vector<double> obj(1 + numQ, 0.0);
+            std::iota(cols.begin(), cols.end(), 0);
+            obj[0] = 1;
+            CPXXchgobjsen(env, lp, CPX_MAX);
+            CPXXchgprobtype(env, lp, CPXPROB_MILP);
+            CPXXchgobj(env, lp, 1 + numQ, &cols[0], &obj[0]);
+
+            // Change bounds on objective function variable to make it (-Inf, +Inf)
+            const CPXDIM tau[2] = {0, 0};
+            const char lu[2] = {'L', 'U'};
+            const double bd[2] = {-CPX_INFBOUND, +CPX_INFBOUND};
+            CPXXchgbds(env, lp, 2, tau, lu, bd);
+
+            // z_jk for each uncertain constraint j of each policy k, and sum(j, z_jk) = 1
+            SEP_MILP.zIndex.assign(K, std::vector<CPXDIM>());
+            SEP_MILP.zRow.assign(K, -1);
+            for (unsigned int k = 0; k < K; ++k) {
+                ConstraintExpression zConstraint(modelName("z", k));
+                zConstraint.sign('E');
+                zConstraint.RHS(1);
+                for (unsigned int j = 0; j < pInfo->getConstraintsXYQ()[k].size(); j++) {
+                    const CPXDIM z_index = CPXXgetnumcols(env, lp);
+                    addVariable(env, lp, 'B', 0, 1, 0, modelName("z", j, k));
+                    SEP_MILP.zIndex[k].emplace_back(z_index);
+                    zConstraint.addTermX(z_index, 1.0);
+                }
+                if (!zConstraint.isEmpty()) {
+                    SEP_MILP.zRow[k] = CPXXgetnumrows(env, lp);
+                    zConstraint.addToCplex(env, lp);
+                }
+            }
 
-        // convert problem to maximization MILP with objective = [tau]
-        CPXXchgobjsen(env, lp, CPX_MAX);
-        CPXXchgprobtype(env, lp, CPXPROB_MILP);
-        for (index = 0; index <= U.getNoOfUncertainParameters(); ++index) {
-            double coef = static_cast<double>((index == 0));
-            CPXXchgobj(env, lp, 1, &index, &coef);
+            SEP_MILP.lp = lp;
+            SEP_MILP.K = K;
+            SEP_MILP.revision = U.getRevision();
         }
-        
+        CPXENVptr env = SEP_MILP.env;
+        CPXLPptr  lp  = SEP_MILP.lp;
 
-        // Change bounds on objective function variable to make it (-Inf, +Inf)
-        index = 0; b = 'L'; bd = -CPX_INFBOUND; CPXXchgbds(env, lp, 1, &index, &b, &bd);
-        index = 0; b = 'U'; bd = +CPX_INFBOUND; CPXXchgbds(env, lp, 1, &index, &b, &bd);
-        index = CPXXgetnumcols(env, lp) - 1;
+        // remove indicator constraints of the previous call
+        const CPXDIM numind = CPXXgetnumindconstrs(env, lp);
+        if (numind > 0) CPXXdelindconstrs(env, lp, 0, numind - 1);
 
         // Add constraints maximizing violation
+        RowBatch& rows = SEP_MILP.rows;
+        std::vector<CPXDIM>& linind = SEP_MILP.linind;
+        std::vector<double>& linval = SEP_MILP.linval;
         for (unsigned int k = 0; k < K; ++k) {
-            CPXDIM rcnt = 0;
-            CPXNNZ nzcnt = 0;
-            std::vector<double> rhs;
-            std::vector<char> sense;
-            std::vector<CPXNNZ> rmatbeg;
-            std::vector<CPXDIM> rmatind;
-            std::vector<CPXDIM> rmatindNew;
-            std::vector<double> rmatval;
 
             // get all uncertain constraints in policy k for fixed x
-            getYQ_fixedX(k, x, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
+            getYQ_fixedX(k, x, rows);
+            assert(rows.rcnt == (CPXDIM)SEP_MILP.zIndex[k].size());
             
             if(DECISION_DEPENDENT)
-                rmatind = pInfo->mapParamK(k, rmatind);
-            
-            // sum(j, z_jk) = 1
-            ConstraintExpression zConstraint("z(" + std::to_string(k) + ")");
-            zConstraint.sign('E');
-            zConstraint.RHS(1);
+                pInfo->mapParamK(k, rows.rmatind, rows.rmatind);
 
-            for (CPXDIM j = 0; j < rcnt; j++) {
-                assert(sense[j] == 'G' || sense[j] == 'L');
+            int numActive = 0;
+            for (CPXDIM j = 0; j < rows.rcnt; j++) {
+                assert(rows.sense[j] == 'G' || rows.sense[j] == 'L');
 
                 // define linear portion of indicator constraint
                 // z_jk => -tau + [violation expression of constraint j in terms of q for fixed x in policy k] >= 0
-                CPXNNZ ilim = (j+1 == rcnt) ? nzcnt : rmatbeg[j+1];
-                double linrhs = rhs[j];
-                int linsense = (sense[j] == 'G') ? 'L' : 'G';
-                std::vector<CPXDIM> linind(rmatind.begin() + rmatbeg[j], rmatind.begin() + ilim);
-                std::vector<double> linval(rmatval.begin() + rmatbeg[j], rmatval.begin() + ilim);
-                std::string indname = "tau(" + std::to_string(j) + "," + std::to_string(k) + ")";
+                double linrhs = rows.rhs[j];
+                int linsense = (rows.sense[j] == 'G') ? 'L' : 'G';
+                linind.assign(rows.rmatind.begin() + rows.rowBegin(j), rows.rmatind.begin() + rows.rowEnd(j));
+                linval.assign(rows.rmatval.begin() + rows.rowBegin(j), rows.rmatval.begin() + rows.rowEnd(j));
+                const std::string indname = modelName("tau", j, k);
+
+                // z_jk may only be selected if constraint j depends on q for this x
+                const char ub = 'U';
+                const double zub = linind.empty() ? 0 : 1;
+                CPXXchgbds(env, lp, 1, &SEP_MILP.zIndex[k][j], &ub, &zub);
 
                 if (!linind.empty()) {
                     // add tau term
                     linind.emplace_back(0);
-                    linval.emplace_back((sense[j] == 'G') ? 1 : -1);
-
-                    // define z_jk
-                    const int z_index = ++index;
-                    addVariable(env, lp, 'B', 0, 1, 0, "z(" + std::to_string(j) + "," + std::to_string(k) + ")");
+                    linval.emplace_back((rows.sense[j] == 'G') ? 1 : -1);
 
                     // add indicator constraint
-                    CPXXaddindconstr(env, lp, z_index, 0, linind.size(), linrhs, linsense, &linind[0], &linval[0], indname.c_str());
-
-                    // UPDATE original constraints
-                    zConstraint.addTermX(z_index, 1.0);
+                    CPXXaddindconstr(env, lp, SEP_MILP.zIndex[k][j], 0, linind.size(), linrhs, linsense, &linind[0], &linval[0], indname.empty() ? NULL : indname.c_str());
+                    numActive++;
                 }
             }
 
-            // add constraints only if at least one non-zero was added
-            if (!zConstraint.isEmpty()) {
-                zConstraint.addToCplex(env, lp);
+            // sum(j, z_jk) = 1 only if at least one z_jk can be selected
+            if (SEP_MILP.zRow[k] >= 0) {
+                const double zrhs = numActive ? 1 : 0;
+                CPXXchgrhs(env, lp, 1, &SEP_MILP.zRow[k], &zrhs);
             }
         }
 
+        // start from the previous worst case (q only; CPLEX completes tau and z)
+        const int nummipstarts = CPXXgetnummipstarts(env, lp);
+        if (nummipstarts > 0) CPXXdelmipstarts(env, lp, 0, nummipstarts - 1);
+        if ((CPXDIM)SEP_MILP.lastQ.size() == 1 + numQ) {
+            const CPXNNZ beg = 0;
+            const int effortlevel = CPX_MIPSTART_AUTO;
+            std::vector<CPXDIM> varindices(numQ);
+            std::iota(varindices.begin(), varindices.end(), 1);
+            CPXXaddmipstarts(env, lp, 1, numQ, &beg, &varindices[0], &SEP_MILP.lastQ[1], &effortlevel, NULL);
+        }
+
         // solve MILP
         status = CPXXmipopt(env, lp);
         
@@ -2036,15 +2137,15 @@ bool KAdaptableSolver::feasible_YQ(const std::vector<double>& x, const unsigned
             status = CPXXgetstat(env, lp);
             if (status == CPXMIP_OPTIMAL || status == CPXMIP_OPTIMAL_TOL) {
                 status = 0;
-                q.resize(1 + U.getNoOfUncertainParameters());
-                CPXXgetx(env, lp, &q[0], 0, U.getNoOfUncertainParameters());
+                q.resize(1 + numQ);
+                CPXXgetx(env, lp, &q[0], 0, numQ);
+                SEP_MILP.lastQ = q;
                 if (GET_MAX_VIOL) {
                     if (q[0] > max_q[0]) {
                         max_q = q;
                     }
                 }
                 else if (q[0] > EPS_INFEASIBILITY_Q) {
-                    CPXXfreeprob(env, &lp);
                     return false;
                 }
             }
@@ -2055,9 +2156,6 @@ bool KAdaptableSolver::feasible_YQ(const std::vector<double>& x, const unsigned
         else {
             MYERROR(status);
         }
-        
-        // Free memory
-        CPXXfreeprob(env, &lp);
     }
 
 
@@ -2085,6 +2183,9 @@ bool KAdaptableSolver::feasible_YQ(const std::vector<double>& x, const unsigned
     // Obtain worst violation?
     double maxViol = -std::numeric_limits<double>::max();
     int label_max = 0;
+
+    // worst-case parameters (reused across constraints)
+    std::vector<double> qbuf;
     
     // Check each label
     for (label = 0; label < (int)samples.size(); label++) {
@@ -2099,13 +2200,16 @@ bool KAdaptableSolver::feasible_YQ(const std::vector<double>& x, const unsigned
         for (k = 0; k < K; k++) {
             bool isPolicyFeasible = true;
             double policyViol = -std::numeric_limits<double>::max();
-            for (const auto& con: pInfo->getConstraintsXYQ()[k]) {
+            const auto& C_XYQ = pInfo->getConstraintsXYQ()[k];
+            const auto& CB_XYQ = pInfo->getBlockXYQ()[k];
+            for (unsigned int j = 0; j < CB_XYQ.size(); j++) {
                 double v;
                 if(DECISION_DEPENDENT){
-                    v = getViolation(con, U, x)[0];
+                    getViolation(C_XYQ[j], U, x, qbuf);
+                    v = qbuf[0];
                 }
                 else
-                    v = getViolation(con, x, samples[label]);
+                    v = CB_XYQ[j].getViolation(x, samples[label]);
 
                 if (GET_MAX_VIOL) {
                     if (v > policyViol) {
@@ -2173,6 +2277,7 @@ bool KAdaptableSolver::feasible_RobustYQ(const std::vector<double>& x, const std
     
     // Obtain worst violation?
     double maxViol = -std::numeric_limits<double>::max();
+    std::vector<double> qtemp;
     
     // Check each label of q
     int label;
@@ -2184,10 +2289,9 @@ bool KAdaptableSolver::feasible_RobustYQ(const std::vector<double>& x, const std
         
         int cstrTemp = 0;
         for (const auto& con: pInfo->getConstraintsXYQ()[0]) {
-            std::vector<double> qtemp;
             double v;
             
-            qtemp = getViolation(con, U, x);
+            getViolation(con, U, x, qtemp);
             v = qtemp[0];
         
             if (GET_MAX_VIOL) {
@@ -2220,6 +2324,71 @@ bool KAdaptableSolver::feasible_RobustYQ(const std::vector<double>& x, const std
     return true;
 }
 
+//-----------------------------------------------------------------------------------
+
+bool KAdaptableSolver::feasible_RobustYQ(const std::vector<double>& x, const std::vector<std::vector<double> >& samples, const unsigned int m, std::vector<std::vector<double> >& qs, std::vector<int>& labelCstr, std::vector<int>& labelq, bool heur) const {
+    assert(m >= 1);
+    const double eps = (heur ? 1.E-2 : EPS_INFEASIBILITY_Q);
+
+    qs.clear();
+    labelCstr.clear();
+    labelq.clear();
+
+    // worst-case parameters (reused across constraints)
+    std::vector<double> qtemp;
+
+    // Check each label of q
+    for (int label = 0; label < (int)samples.size(); label++) {
+
+        pInfo->setXiBar(samples[label]);
+        UNCSetCPtr U = &pInfo->getUncSet();
+
+        // most violated constraint of this scenario
+        double maxViol = -std::numeric_limits<double>::max();
+        std::vector<double> q;
+        int cstr = -1;
+
+        int cstrTemp = 0;
+        for (const auto& con: pInfo->getConstraintsXYQ()[0]) {
+            getViolation(con, U, x, qtemp);
+            if (qtemp[0] > maxViol) {
+                maxViol = qtemp[0];
+                q.swap(qtemp);
+                cstr = cstrTemp;
+            }
+            if (!GET_MAX_VIOL && maxViol > eps) break;
+            cstrTemp ++;
+        }
+
+        if (maxViol > eps) {
+            qs.emplace_back(q);
+            labelCstr.emplace_back(cstr);
+            labelq.emplace_back(label);
+            if (!GET_MAX_VIOL && qs.size() >= m) break;
+        }
+    }
+    pInfo->resetXiBar();
+
+    // keep the m most violated
+    std::vector<int> order(qs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](const int a, const int b) { return qs[a][0] > qs[b][0]; });
+    if (order.size() > m) order.resize(m);
+
+    std::vector<std::vector<double> > qs_m;
+    std::vector<int> labelCstr_m, labelq_m;
+    for (const auto& i : order) {
+        qs_m.emplace_back(std::move(qs[i]));
+        labelCstr_m.emplace_back(labelCstr[i]);
+        labelq_m.emplace_back(labelq[i]);
+    }
+    qs.swap(qs_m);
+    labelCstr.swap(labelCstr_m);
+    labelq.swap(labelq_m);
+
+    return qs.empty();
+}
+
 //-----------------------------------------------------------------------------------
 //-----------------------------------------------------------------------------------
 //-----------------------------------------------------------------------------------
@@ -2246,11 +2415,11 @@ bool KAdaptableSolver::feasible_DET(const std::vector<double>& x, const std::vec
         return 0;
     }
     assert(xx == x);
-    for (const auto& con: pInfo->getConstraintsXQ()) {
-        if (getViolation(con, x, q) > EPS_INFEASIBILITY_Q) return 0;
+    for (const auto con: pInfo->getBlockXQ()) {
+        if (con.getViolation(x, q) > EPS_INFEASIBILITY_Q) return 0;
     }
-    for (const auto& con: pInfo->getConstraintsXYQ()[0]) {
-        if (getViolation(con, x, q) > EPS_INFEASIBILITY_Q) return 0;
+    for (const auto con: pInfo->getBlockXYQ()[0]) {
+        if (con.getViolation(x, q) > EPS_INFEASIBILITY_Q) return 0;
     }
 
     return true;
@@ -2527,6 +2696,7 @@ int KAdaptableSolver::solve_SRO_cuttingPlane(std::vector<double>& x) {
     CPXXsetintparam(env, CPX_PARAM_PRELINEAR, CPX_OFF);
     CPXXsetusercutcallbackfunc(env, cutCB_solve_SRO_cuttingPlane, this);
     CPXXsetlazyconstraintcallbackfunc(env, cutCB_solve_SRO_cuttingPlane, this);
+    ScopedCutPool pool(cutPool);
 
     // solve problem
     status = CPXXmipopt(env, lp);
@@ -2611,6 +2781,149 @@ int KAdaptableSolver::solve_ScSRO(const std::vector<std::vector<double> >& sampl
     return status;
 }
 
+//-----------------------------------------------------------------------------------
+
+int KAdaptableSolver::solve_ClusteredScSRO(const std::vector<std::vector<double> >& samples, const std::vector<double>& x, const unsigned int K, const double timeLimit, std::vector<double>& xheur) const {
+    assert(pInfo);
+
+    // vectors must be of appropriate size
+    if (K < 1) MYERROR(EXCEPTION_K);
+    if (x.size() != MY_SIZE_X(K)) MYERROR(EXCEPTION_X);
+    for (const auto& q : samples) {
+        if ((int)q.size() != MY_SIZE_Q) MYERROR(EXCEPTION_Q);
+    }
+
+    // need at least one scenario per policy
+    const unsigned int S = samples.size();
+    if (S < K) return 1;
+
+
+    // constraint-activity vector of each scenario w.r.t. the 1st policy of x
+    // (positive entries are violations, entries close to zero are binding constraints)
+    RowBatch rows;
+    std::vector<std::vector<double> > activity(S);
+    for (unsigned int s = 0; s < S; s++) {
+        getYQ_fixedQ(0, samples[s], rows);
+        activity[s].assign(rows.rcnt, 0.0);
+        for (CPXDIM i = 0; i < rows.rcnt; i++) {
+            double lhs = 0;
+            for (CPXNNZ j = rows.rowBegin(i), next = rows.rowEnd(i); j < next; j++) {
+                lhs += rows.rmatval[j] * x[rows.rmatind[j]];
+            }
+            if (rows.sense[i] == 'L') activity[s][i] = lhs - rows.rhs[i];
+            else if (rows.sense[i] == 'G') activity[s][i] = rows.rhs[i] - lhs;
+            else activity[s][i] = std::abs(lhs - rows.rhs[i]);
+        }
+    }
+
+    auto distance = [&](const std::vector<double>& a, const std::vector<double>& b) {
+        double d = 0;
+        for (unsigned int i = 0; i < a.size(); i++) d += (a[i] - b[i]) * (a[i] - b[i]);
+        return d;
+    };
+
+
+    // initial centers: nominal scenario + farthest-point selection
+    std::vector<std::vector<double> > centers(1, activity[0]);
+    std::vector<double> minDist(S, std::numeric_limits<double>::max());
+    while (centers.size() < K) {
+        unsigned int next = 0;
+        for (unsigned int s = 0; s < S; s++) {
+            minDist[s] = std::min(minDist[s], distance(activity[s], centers.back()));
+            if (minDist[s] > minDist[next]) next = s;
+        }
+        centers.emplace_back(activity[next]);
+    }
+
+
+    // k-means iterations on the activity vectors
+    std::vector<unsigned int> assign(S, 0);
+    for (int iter = 0; iter < CLUSTER_HEUR_MAX_ITER; iter++) {
+        bool changed = false;
+        for (unsigned int s = 0; s < S; s++) {
+            unsigned int best = 0;
+            double bestDist = distance(activity[s], centers[0]);
+            for (unsigned int k = 1; k < K; k++) {
+                const double d = distance(activity[s], centers[k]);
+                if (d < bestDist) {
+                    bestDist = d;
+                    best = k;
+                }
+            }
+            if (iter == 0 || assign[s] != best) changed = true;
+            assign[s] = best;
+        }
+        if (!changed) break;
+
+        std::vector<unsigned int> count(K, 0);
+        for (auto& c : centers) std::fill(c.begin(), c.end(), 0.0);
+        for (unsigned int s = 0; s < S; s++) {
+            count[assign[s]]++;
+            for (unsigned int i = 0; i < activity[s].size(); i++) centers[assign[s]][i] += activity[s][i];
+        }
+        for (unsigned int k = 0; k < K; k++) {
+            if (count[k]) for (auto& v : centers[k]) v /= count[k];
+        }
+    }
+
+
+    // restricted problem: policy k must be feasible for the scenarios in cluster k only
+    // NOTE: the K restricted problems share the 1st-stage decisions, so they are
+    //       solved jointly as one scenario-based problem instead of one per cluster
+    int status = 0;
+    ClusterHeuristicModel& M = CLUSTER_HEUR;
+
+    // (re)build the scenario-independent part
+    if (!M.lp || M.K != K) {
+        if (M.lp) CPXXfreeprob(M.env, &M.lp);
+        if (!M.env) {
+            M.env = CPXXopenCPLEX(&status);
+            if (!M.env) MYERROR(EXCEPTION_CPXINIT);
+            setCPXoptions(M.env);
+        }
+        M.lp = CPXXcreateprob(M.env, &status, "CLUSTERED_SAMPLE_BASED_K_ADAPTABILITY");
+        if (!M.lp) MYERROR(EXCEPTION_CPXINIT);
+
+        // define variables and constraints
+        updateX(M.env, M.lp);
+        for (unsigned int k = 0; k < K; k++) {
+            updateY(M.env, M.lp, k);
+        }
+        M.K = K;
+        M.numCols = CPXXgetnumcols(M.env, M.lp);
+        M.numRows = CPXXgetnumrows(M.env, M.lp);
+    }
+    CPXENVptr env = M.env;
+    CPXLPptr lp = M.lp;
+
+    // replace the scenario constraints of the previous call
+    if (CPXXgetnumrows(env, lp) > M.numRows) CPXXdelrows(env, lp, M.numRows, CPXXgetnumrows(env, lp) - 1);
+    if (CPXXgetnumcols(env, lp) > M.numCols) CPXXdelcols(env, lp, M.numCols, CPXXgetnumcols(env, lp) - 1);
+    for (unsigned int s = 0; s < S; s++) {
+        updateXQ(env, lp, samples[s]);
+        updateYQ(env, lp, assign[s], samples[s]);
+    }
+
+    // set options
+    CPXXsetdblparam(env, CPXPARAM_TimeLimit, timeLimit);
+    CPXXchgprobtype(env, lp, (pInfo->isContinuous() ? CPXPROB_LP : CPXPROB_MILP));
+    CPXXchgobjsen(env, lp, CPX_MIN);
+
+    // solve problem
+    status = (pInfo->isContinuous() ? CPXXlpopt(env, lp) : CPXXmipopt(env, lp));
+    if (!status) {
+        status = CPXXgetstat(env, lp);
+        if (status == CPX_STAT_OPTIMAL || status == CPXMIP_OPTIMAL || status == CPXMIP_OPTIMAL_TOL || status == CPXMIP_TIME_LIM_FEAS) {
+            status = 0;
+            xheur.resize(CPXXgetnumcols(env, lp));
+            CPXXgetx(env, lp, &xheur[0], 0, xheur.size() - 1);
+            assert(xheur.size() == MY_SIZE_X(K));
+        }
+    }
+
+    return status;
+}
+
 //-----------------------------------------------------------------------------------
 int KAdaptableSolver::solve_YQRobust_cuttingplane(const std::vector<double>& qini) {
     
@@ -2655,17 +2968,11 @@ int KAdaptableSolver::solve_YQRobust_cuttingplane(const std::vector<double>& qin
     //std::vector<double> qtemp = pInfo->getNominal();
     inner_samples.emplace_back(qini);
     
-    CPXDIM rcnt = 0;
-    CPXNNZ nzcnt = 0;
-    std::vector<double> rhs;
-    std::vector<char> sense;
-    std::vector<CPXNNZ> rmatbeg;
-    std::vector<CPXDIM> rmatind;
-    std::vector<double> rmatval;
+    RowBatch rows;
     
     // add initial constraint
-    getYQ_fixedQ(0, qini, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
-    CPXXaddrows(env, lp, 0, rcnt, nzcnt, &rhs[0], &sense[0], &rmatbeg[0], &rmatind[0], &rmatval[0], NULL, NULL);
+    getYQ_fixedQ(0, qini, rows);
+    CPXXaddrows(env, lp, 0, rows.rcnt, rows.nzcnt, rows.rhs.data(), rows.sense.data(), rows.rmatbeg.data(), rows.rmatind.data(), rows.rmatval.data(), NULL, NULL);
     
     std::vector<CPXDIM> indices;
     indices.resize(pInfo->getNumVars());
@@ -2693,25 +3000,17 @@ int KAdaptableSolver::solve_YQRobust_cuttingplane(const std::vector<double>& qin
         
         if (CPXXgetx(env, lp, &x[0], 0, x.size() - 1) == 0) {
             
-            rcnt = 0;
-            nzcnt = 0;
-            rhs.clear();
-            sense.clear();
-            rmatbeg.clear();
-            rmatind.clear();
-            rmatval.clear();
-            
             if (!feasible_XQ(x, q)) {
                 // get all constraints
-                getXQ_fixedQ(q, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
-                CPXXaddrows(env, lp, 0, rcnt, nzcnt, &rhs[0], &sense[0], &rmatbeg[0], &rmatind[0], &rmatval[0], NULL, NULL);
+                getXQ_fixedQ(q, rows);
+                CPXXaddrows(env, lp, 0, rows.rcnt, rows.nzcnt, rows.rhs.data(), rows.sense.data(), rows.rmatbeg.data(), rows.rmatind.data(), rows.rmatval.data(), NULL, NULL);
                 
                 inner_samples.emplace_back(q);
             }
             else if (!feasible_YQ(x, 1, q)) {
                 // get all constraints
-                getYQ_fixedQ(0, q, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
-                CPXXaddrows(env, lp, 0, rcnt, nzcnt, &rhs[0], &sense[0], &rmatbeg[0], &rmatind[0], &rmatval[0], NULL, NULL);
+                getYQ_fixedQ(0, q, rows);
+                CPXXaddrows(env, lp, 0, rows.rcnt, rows.nzcnt, rows.rhs.data(), rows.sense.data(), rows.rmatbeg.data(), rows.rmatind.data(), rows.rmatval.data(), NULL, NULL);
                 
                 inner_samples.emplace_back(q);
             }
@@ -2736,6 +3035,7 @@ int KAdaptableSolver::solve_YQRobust_cuttingplane(const std::vector<double>& qin
     CPXXsetintparam(env, CPX_PARAM_PRELINEAR, CPX_OFF);
     //CPXXsetusercutcallbackfunc(env, cutCB_solve_SRO_cuttingPlane, this);
     CPXXsetlazyconstraintcallbackfunc(env, cutCB_solve_SRO_cuttingPlane, this);
+    ScopedCutPool pool(cutPool);
 
     // solve problem
     status = CPXXmipopt(env, lp);
@@ -2788,7 +3088,7 @@ int KAdaptableSolver::solve_L_Shaped(const unsigned int K, std::ostream& out, co
     setL(xTemp[0]);
     // int size = getTrueWSize();
     
-    addVariable(env, lp, 'C', L, +CPX_INFBOUND, 1.0, "theta");
+    addVariable(env, lp, 'C', L, +CPX_INFBOUND, 1.0, modelName("theta"));
     
     pInfo->isConsistentWithDesign();
     
@@ -2798,19 +3098,7 @@ int KAdaptableSolver::solve_L_Shaped(const unsigned int K, std::ostream& out, co
     int begin = X.getFirstOfVarType("w");
     
     for (int i = 0; i < X.getVarTypeSize("w"); i++) if (!X.isUndefVar(i + begin)) {
-        std::string cname;
-        int ind1, ind2, ind3, ind4, ind5;
-        
-        X.getVarInfo(begin+i, cname, ind1, ind2, ind3, ind4, ind5);
-        if (ind1 > -1) {
-            cname += "(" + std::to_string(ind1);
-            if (ind2 > -1) cname += "," + std::to_string(ind2);
-            if (ind3 > -1) cname += "," + std::to_string(ind3);
-            if (ind4 > -1) cname += "," + std::to_string(ind4);
-            if (ind5 > -1) cname += "," + std::to_string(ind5);
-            cname += ")";
-        }
-        addVariable(env, lp, 'B', 0.0, 1.0, CoefW[i], cname);
+        addVariable(env, lp, 'B', 0.0, 1.0, CoefW[i], columnName(X, begin + i));
     }
 
     // Robustify w
@@ -2940,9 +3228,8 @@ int KAdaptableSolver::solveRelax(const std::vector<bool>& w, const std::vector<s
     std::vector<int> y_ind(newK, 0);
     for(int k = 0; k <= newK - 1; k++){
         updateY(env_sub, lp_sub, k);
-        std::string cname("y_");
-        cname += std::to_string(k) + "(0)";
-        CPXXgetcolindex (env_sub, lp_sub, cname.c_str(), &y_ind[k]);
+        // column of y_k(0) (q is fixed, so no dual variables precede it)
+        y_ind[k] = MY_SIZE_X(k) + pInfo->getVarsY().getDefVarLinIndex("y", 0);
         updateXQ(env_sub, lp_sub, q[k]);
         updateYQ(env_sub, lp_sub, k, q[k]);
     }
@@ -3382,7 +3669,7 @@ int KAdaptableSolver::solve_KAdaptability(const unsigned int K, const bool h, st
     CPXXsetlazyconstraintcallbackfunc(env, cutCB_solve_KAdaptability_cuttingPlane, this);
     CPXXsetbranchcallbackfunc(env, branchCB_solve_KAdaptability_cuttingPlane, this);
     CPXXsetincumbentcallbackfunc(env, incCB_solve_KAdaptability_cuttingPlane, this);
-    if (heuristic_mode && K > 1) CPXXsetheuristiccallbackfunc(env, heurCB_solve_KAdaptability_cuttingPlane, this);
+    if ((heuristic_mode || USE_CLUSTER_HEURISTIC) && K > 1) CPXXsetheuristiccallbackfunc(env, heurCB_solve_KAdaptability_cuttingPlane, this);
     CPXXsetdeletenodecallbackfunc(env, deletenodeCB_solve_KAdaptability_cuttingPlane, this);
     if (COLLECT_RESULTS && K > 2) {
         CPXXsetnodecallbackfunc(env, nodeCB_solve_KAdaptability_cuttingPlane, this);
@@ -3436,11 +3723,16 @@ int KAdaptableSolver::solve_KAdaptability(const unsigned int K, const bool h, st
         }
     }
 
-    // (time, incumbent) data
-    ZT_VALUES.clear();
-    NUM_DUMMY_NODES = TX = 0;
+    // (time, incumbent, bound, nodes) data
+    bb_trace.reset(TRACE_CAPACITY);
+    NUM_DUMMY_NODES = 0;
+    CLUSTER_HEUR.freeProb();
+    INCUMBENT_CACHE.clear();
+    INCUMBENT_CACHE_HITS = INCUMBENT_CACHE_QUERIES = 0;
+    pInfo->getUncSet().resetSeparationCacheStats();
+    pInfo->getUncSetK().resetSeparationCacheStats();
+    ScopedCutPool pool(cutPool);
     START_TS = get_wall_time();
-    BOUND_VALUES.clear();
 
 
     
@@ -3507,6 +3799,26 @@ int KAdaptableSolver::solve_KAdaptability(const unsigned int K, const bool h, st
 
 
         
+    }
+
+    // cut pool and cache statistics -- kept out of the results table (one line per run)
+    if (OUTPUTLEVEL >= 2) {
+        if (USE_CUT_POOL && cutPool->numAdded) {
+            std::cerr << " Cut pool: " << cutPool->numAdded << " added, " << cutPool->numDuplicates << " duplicates, "
+                      << cutPool->numReused << " reused, " << cutPool->numPurged << " purged\n";
+        }
+        if (USE_INCUMBENT_CACHE && INCUMBENT_CACHE_QUERIES) {
+            std::cerr << " Incumbent cache: " << INCUMBENT_CACHE_HITS << " hits / " << INCUMBENT_CACHE_QUERIES << " queries ("
+                      << std::setprecision(2) << std::fixed << 100.0 * INCUMBENT_CACHE_HITS / INCUMBENT_CACHE_QUERIES << "%)\n";
+        }
+        // separation problems over U and over the lifted set Uk (decision-dependent case)
+        const UncertaintySet& U = pInfo->getUncSet(), & Uk = pInfo->getUncSetK();
+        const auto sepHits = U.getSeparationCacheHits() + Uk.getSeparationCacheHits();
+        const auto sepQueries = sepHits + U.getSeparationCacheMisses() + Uk.getSeparationCacheMisses();
+        if (sepQueries) {
+            std::cerr << " Separation cache: " << sepHits << " hits / " << sepQueries << " queries ("
+                      << std::setprecision(2) << std::fixed << 100.0 * sepHits / sepQueries << "%)\n";
+        }
     }
     
     if(!roSol.size() && bb_samples_all.size() && final_labels.size())
@@ -3550,6 +3862,13 @@ int KAdaptableSolver::solve_KAdaptability(const unsigned int K, const bool h, st
         }
     }
     
+    // export the (time, incumbent, bound, nodes) trace
+    if (!traceFileName.empty()) {
+        std::ofstream traceFile(traceFileName);
+        if (traceFile) bb_trace.write(traceFile);
+        else if (OUTPUTLEVEL >= 1) std::cerr << "Warning: could not open trace file " << traceFileName << ". Ignoring. \n";
+    }
+
     // clear solutions
     // xsol.clear();
     xstatic.clear();
@@ -3560,8 +3879,10 @@ int KAdaptableSolver::solve_KAdaptability(const unsigned int K, const bool h, st
     bb_samples_all.clear();
     final_labels.clear();
     
-    // clear (time, incumbent) data
-    ZT_VALUES.clear();
+    // clear incumbent cache -- bb_trace is kept until the next solve
+    INCUMBENT_CACHE.clear();
+    SEP_MILP.freeProb();
+    CLUSTER_HEUR.freeProb();
 
     // Free memory
     CPXXfreeprob(env, &lp);
@@ -3642,16 +3963,16 @@ int KAdaptableSolver::solve_KAdaptability_minMaxMin(const unsigned int K, std::v
     CPXLPptr lp = NULL;
     env = CPXXopenCPLEX(&status);
     lp = CPXXcreateprob(env, &status, "MIN_MAX_MIN");
-    addVariable(env, lp, 'C', zstar, zstar, 0.0, "zstar");
+    addVariable(env, lp, 'C', zstar, zstar, 0.0, modelName("zstar"));
     for (int n = 1; n <= pInfo->getNumSecondStage(); n++) {
-        addVariable(env, lp, 'C', -CPX_INFBOUND, +CPX_INFBOUND, 0.0, "xstar(" + std::to_string(n) + ")");
+        addVariable(env, lp, 'C', -CPX_INFBOUND, +CPX_INFBOUND, 0.0, modelName("xstar", n));
     }
     assert(CPXXgetnumcols(env, lp) == (int)xtemp.size());
     for (unsigned int j = 0; j < i; j++) {
-        addVariable(env, lp, 'C', 0.0, +CPX_INFBOUND, 0.0, "lambda(" + std::to_string(j) + ")");
+        addVariable(env, lp, 'C', 0.0, +CPX_INFBOUND, 0.0, modelName("lambda", j));
     }
     ConstraintExpression constraint;
-    constraint.rowname("convex");
+    constraint.rowname(modelName("convex"));
     constraint.sign('E');
     constraint.RHS(1.0);
     for (unsigned int j = 0; j < i; j++) {
@@ -3662,7 +3983,7 @@ int KAdaptableSolver::solve_KAdaptability_minMaxMin(const unsigned int K, std::v
         constraint.clear();
         constraint.RHS(0);
         constraint.sign('E');
-        constraint.rowname("xdef(" + std::to_string(n) + ")");
+        constraint.rowname(modelName("xdef", n));
         for (unsigned int j = 0; j < i; j++) {
             double coef = getXPolicy(xm3, i, j)[n];
             if (coef != 0.0) constraint.addTermX(xtemp.size() + j, coef);
@@ -3824,28 +4145,36 @@ static int CPXPUBLIC cutCB_solve_SRO_cuttingPlane(CPXCENVptr env, void *cbdata,
     std::vector<double> q;
     *useraction_p = CPX_CALLBACK_DEFAULT;
 
+    // first try to reuse a cut from the pool -- cuts of the static robust problem are globally valid,
+    // so they are kept in a single group (label 0) regardless of the scenario they were generated from
+    static const std::vector<int> SRO_GROUP(1, 0);
+    if (USE_CUT_POOL) {
+        if (S->cutPool->nextRound() % CUT_POOL_PURGE_FREQ == 0) S->cutPool->purge(CUT_POOL_PURGE_AGE);
+        const auto cut = S->cutPool->findViolated(0, SRO_GROUP, x, EPS_INFEASIBILITY_Q);
+        if (cut) {
+            CPXXcutcallbackaddlocal(env, cbdata, wherefrom, cut->ind.size(), cut->rhs, cut->sense, &cut->ind[0], &cut->val[0]);
+            *useraction_p = CPX_CALLBACK_SET;
+            exitCallback(cutCB_solve_SRO_cuttingPlane);
+        }
+    }
 
-    // violated cuts
-    CPXDIM rcnt = 0;
-    CPXNNZ nzcnt;
-    std::vector<double> rhs;
-    std::vector<char> sense;
-    std::vector<CPXNNZ> rmatbeg;
-    std::vector<CPXDIM> rmatind;
-    std::vector<double> rmatval;
+
+    // violated cuts (workspace is reused across calls)
+    static RowBatch rows;
+    rows.clear();
     
 //    if(!DECISION_DEPENDENT){
         // check constraints (x, q)
         if (!S->feasible_XQ(x, q)) {
 
             // get all constraints
-            S->getXQ_fixedQ(q, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
+            S->getXQ_fixedQ(q, rows);
             S->inner_samples.emplace_back(q);
             
         }
         else if (!S->feasible_YQ(x, 1, q)) {
             // get all constraints
-            S->getYQ_fixedQ(0, q, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
+            S->getYQ_fixedQ(0, q, rows);
             S->inner_samples.emplace_back(q);
         }
         else {
@@ -3856,29 +4185,24 @@ static int CPXPUBLIC cutCB_solve_SRO_cuttingPlane(CPXCENVptr env, void *cbdata,
         double maxViol = 0;
         double rhs_cut = 0;
         char sense_cut = 'L';
+        int cstr_cut = -1;
         std::vector<int> cutind;
         std::vector<double> cutval;
-        for (CPXDIM i = 0; i < rcnt; i++) {
-
-            // coefficients and indices of this constraint
-            CPXDIM next = (i + 1 == rcnt) ? nzcnt : rmatbeg[i+1];
-            std::vector<int> cutind_i(rmatind.begin() + rmatbeg[i], rmatind.begin() + next);
-            std::vector<double> cutval_i(rmatval.begin() + rmatbeg[i], rmatval.begin() + next);
-
-            // check violation
-            const auto W = checkViol(env, cbdata, wherefrom, rhs[i], sense[i], cutind_i, cutval_i);
-            if (W.first > maxViol) {
-                maxViol = W.first;
-                rhs_cut = rhs[i];
-                sense_cut = sense[i];
-                cutind = cutind_i;
-                cutval = cutval_i;
-            }
+        const auto W = mostViolatedRow(env, cbdata, wherefrom, rows);
+        if (W.first > maxViol) {
+            const CPXDIM i = W.second;
+            maxViol = W.first;
+            rhs_cut = rows.rhs[i];
+            sense_cut = rows.sense[i];
+            cstr_cut = i;
+            cutind.assign(rows.rmatind.begin() + rows.rowBegin(i), rows.rmatind.begin() + rows.rowEnd(i));
+            cutval.assign(rows.rmatval.begin() + rows.rowBegin(i), rows.rmatval.begin() + rows.rowEnd(i));
         }
 
         // Add local cut to be consistent with K-Adaptability implementation
         if (maxViol > EPS_INFEASIBILITY_Q) {
             CPXXcutcallbackaddlocal(env, cbdata, wherefrom, cutind.size(), rhs_cut, sense_cut, &cutind[0], &cutval[0]);//, CPX_USECUT_FORCE);
+            if (USE_CUT_POOL) S->cutPool->add(0, SRO_GROUP[0], cstr_cut, rhs_cut, sense_cut, cutind, cutval);
             *useraction_p = CPX_CALLBACK_SET;
         }
 //    }
@@ -3970,16 +4294,52 @@ static int CPXPUBLIC incCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, void
 
 
 
+    // Look up candidate in cache: integer parts rounded, continuous parts on a fine grid, plus node labels
+    CPXXgetcallbacknodeinfo(env, cbdata, wherefrom, 0, CPX_CALLBACK_INFO_NODE_USERHANDLE, &nodeData);
+    std::vector<long long> key;
+    bool cached = false;
+    if (USE_INCUMBENT_CACHE) {
+        std::vector<char> xctype(numcols, CPX_CONTINUOUS);
+        CPXXgetctype(env, lp, &xctype[0], 0, numcols - 1);
+        key.reserve(numcols + 1);
+        for (CPXDIM j = 0; j < numcols; j++) {
+            key.emplace_back(xctype[j] == CPX_CONTINUOUS ? std::llround(x[j] / INCUMBENT_CACHE_ROUND) : std::llround(x[j]));
+        }
+        if (nodeData) for (const auto& labels_k : static_cast<CPLEX_CB_node*>(nodeData)->labels) {
+            key.emplace_back(-1);
+            key.insert(key.end(), labels_k.begin(), labels_k.end());
+        }
+
+        INCUMBENT_CACHE_QUERIES++;
+        const auto it = INCUMBENT_CACHE.find(key);
+        if (it != INCUMBENT_CACHE.end()) {
+            INCUMBENT_CACHE_HITS++;
+            cached = true;
+            label = it->second;
+        }
+    }
+
     // Check feasibility
-    *isfeas_p = !S->solve_separationProblem(x, K, label);
+    if (cached) {
+        *isfeas_p = (label < 0);
+        if (!*isfeas_p) assert(label < static_cast<int>(S->bb_samples.size()));
+    }
+    else {
+        *isfeas_p = !S->solve_separationProblem(x, K, label);
+        if (USE_INCUMBENT_CACHE) INCUMBENT_CACHE.emplace(key, (*isfeas_p ? -1 : label));
+    }
     if (*isfeas_p) {
-        S->setX(x, K);
-        CPXXgetcallbacknodeinfo(env, cbdata, wherefrom, 0, CPX_CALLBACK_INFO_NODE_USERHANDLE, &nodeData);
+        // best known solution was already updated when the candidate was first verified
+        if (!cached) S->setX(x, K);
         if (nodeData){
             S->final_labels = static_cast<CPLEX_CB_node*>(nodeData)->labels;
         }
         
-        if (COLLECT_RESULTS) ZT_VALUES.emplace_back(objval, get_wall_time());
+        if (COLLECT_RESULTS) {
+            double lb = 0;      CPXXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_BEST_REMAINING, &lb);
+            CPXLONG nodes = 0;  CPXXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_NODE_COUNT_LONG, &nodes);
+            S->bb_trace.record({get_wall_time() - START_TS, objval, lb, nodes}, true);
+        }
     }
 
 
@@ -4041,36 +4401,84 @@ static int CPXPUBLIC incCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, void
 
 static int CPXPUBLIC heurCB_solve_KAdaptability_cuttingPlane (CPXCENVptr env, void *cbdata, int wherefrom, void *cbhandle, double *objval_p, double *x_, int *checkfeas_p, int *useraction_p) {
     enterCallback(heur);
+    *useraction_p = CPX_CALLBACK_DEFAULT;
 
     // Get K-Adaptability solver
     auto S = static_cast<KAdaptableSolver*>(cbhandle);
     const unsigned int K = S->NK;
 
+    // errors (MYERROR) must not propagate through CPLEX: give up on the heuristic at this node instead
+    try {
 
-    // Get node solution
-    CPXCLPptr lp = NULL; CPXXgetcallbacklp(env, cbdata, wherefrom, &lp);
-    CPXDIM numcols = CPXXgetnumcols(env, lp);
-    std::vector<double> x(x_, x_ + numcols);
+        // Get node solution
+        CPXCLPptr lp = NULL; CPXXgetcallbacklp(env, cbdata, wherefrom, &lp);
+        CPXDIM numcols = CPXXgetnumcols(env, lp);
+        std::vector<double> x(x_, x_ + numcols);
 
 
-    // Check integer feasibility
-    std::vector<int> feas(numcols, 0); CPXXgetcallbacknodeintfeas(env, cbdata, wherefrom, &feas[0], 0, numcols - 1);
-    if (std::accumulate(feas.begin(), feas.end(), 0) == 0) {
-        double ub = 0; CPXXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_BEST_INTEGER, &ub);
-        x[0] = ub;
-        x[0] = S->getWorstCase(x, K, Q_TEMP);
+        // Scenario-clustering heuristic -- rerun only when new scenarios are available, and
+        // at most every CLUSTER_HEUR_NODE_FREQ nodes unless the incumbent stalls
+        if (!S->heuristic_mode) {
+            ClusterHeuristicModel& M = CLUSTER_HEUR;
+            double ub = 0;      CPXXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_BEST_INTEGER, &ub);
+            CPXLONG nodes = 0;  CPXXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_NODE_COUNT_LONG, &nodes);
+            if (ub < M.lastIncumbent - EPS_INFEASIBILITY_X) {
+                M.lastIncumbent = ub;
+                M.lastImprovementNode = nodes;
+            }
+            if (S->bb_samples.size() < K || S->bb_samples.size() <= M.numSamples) exitCallback(heur);
+            if (M.lastRunNode >= 0) {
+                const bool due = (nodes - M.lastRunNode >= CLUSTER_HEUR_NODE_FREQ);
+                const bool stalled = (nodes - M.lastRunNode >= CLUSTER_HEUR_STALL_NODES) && (nodes - M.lastImprovementNode >= CLUSTER_HEUR_STALL_NODES);
+                if (!due && !stalled) exitCallback(heur);
+            }
 
-        // worst-case objective value is less than current incumbent
-        if (x[0] < ub - EPS_INFEASIBILITY_X) {
-            x_[0] = x[0] + EPS_INFEASIBILITY_X;
-            *objval_p = x_[0];
-            *checkfeas_p = 1;
-            *useraction_p = CPX_CALLBACK_SET;
+            // time left in the main solve
+            double timeLimit = 0; CPXXgetdblparam(env, CPXPARAM_TimeLimit, &timeLimit);
+            timeLimit = std::min(CLUSTER_HEUR_TIME_LIMIT, timeLimit - (get_wall_time() - START_TS));
+            if (timeLimit < CLUSTER_HEUR_MIN_TIME) exitCallback(heur);
+
+            M.numSamples = S->bb_samples.size();
+            M.lastRunNode = nodes;
+
+            std::vector<double> xheur;
+            // skip solutions of the wrong length (they would overrun x_)
+            if (S->solve_ClusteredScSRO(S->bb_samples, x, K, timeLimit, xheur) == 0 && (CPXDIM)xheur.size() == numcols) {
+                xheur[0] = S->getWorstCase(xheur, K, Q_TEMP);
+
+                // worst-case objective value is less than current incumbent
+                if (xheur[0] < ub - EPS_INFEASIBILITY_X) {
+                    xheur[0] += EPS_INFEASIBILITY_X;
+                    std::copy(xheur.begin(), xheur.end(), x_);
+                    *objval_p = x_[0];
+                    *checkfeas_p = 1;
+                    *useraction_p = CPX_CALLBACK_SET;
+                }
+            }
+            exitCallback(heur);
         }
-        else {
-            *useraction_p = CPX_CALLBACK_DEFAULT;
+
+        // Check integer feasibility
+        std::vector<int> feas(numcols, 0); CPXXgetcallbacknodeintfeas(env, cbdata, wherefrom, &feas[0], 0, numcols - 1);
+        if (std::accumulate(feas.begin(), feas.end(), 0) == 0) {
+            double ub = 0; CPXXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_BEST_INTEGER, &ub);
+            x[0] = ub;
+            x[0] = S->getWorstCase(x, K, Q_TEMP);
+
+            // worst-case objective value is less than current incumbent
+            if (x[0] < ub - EPS_INFEASIBILITY_X) {
+                x_[0] = x[0] + EPS_INFEASIBILITY_X;
+                *objval_p = x_[0];
+                *checkfeas_p = 1;
+                *useraction_p = CPX_CALLBACK_SET;
+            }
         }
     }
+    catch (...) {
+        *checkfeas_p = 0;
+        *useraction_p = CPX_CALLBACK_DEFAULT;
+        if (OUTPUTLEVEL >= 1) std::cerr << "Warning: heuristic callback failed. Ignoring. \n";
+    }
 
     exitCallback(heur);
 }
@@ -4098,12 +4506,9 @@ static int CPXPUBLIC branchCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, v
         gap = 100*(bestinteger - nodeobjval)/(1E-10 + std::abs(bestinteger));
     }
     if (COLLECT_RESULTS) {
-        double time_elapsed = get_wall_time() - START_TS;
-        if (time_elapsed > (double)TX*10) {
-            double lb = 0; CPXXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_BEST_REMAINING, &lb);
-            BOUND_VALUES.emplace_back(lb, (existsfeas ? bestinteger : 0));
-            TX++;
-        }
+        double lb = 0;      CPXXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_BEST_REMAINING, &lb);
+        CPXLONG nodes = 0;  CPXXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_NODE_COUNT_LONG, &nodes);
+        S->bb_trace.record({get_wall_time() - START_TS, (existsfeas ? bestinteger : +std::numeric_limits<double>::infinity()), lb, nodes});
     }
 
 
@@ -4233,6 +4638,27 @@ static int CPXPUBLIC branchCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, v
 
 
 
+    //////////////////////////////////////////////////////////////////////
+    // SYMMETRY: DO NOT LET CPLEX BRANCH ON VARIABLES OF EMPTY POLICIES //
+    //////////////////////////////////////////////////////////////////////
+    // Policies without any scenario label are interchangeable, so a 0-1 branch on one of them
+    // only creates equivalent subtrees. Instead, branch as per K-adaptability on a scenario that
+    // is violated by all active policies -- this assigns it to the active policies or to the first
+    // empty policy only, which is the canonical representative of all empty policies.
+    if (BNC_BREAK_SYMMETRY && K > 1 && nodeData && !label && !isDummy && nodecnt > 0 && type == CPX_TYPE_VAR) {
+        auto oldInfo = static_cast<CPLEX_CB_node*>(nodeData);
+        const unsigned int numActive = oldInfo->numActivePolicies;
+        if (numActive < K && !(oldInfo->fromIncumbentCB && oldInfo->br_label == -1)) {
+            if (S->getPolicyOfColumn(indices[nodebeg[0]]) >= (int)numActive) {
+                int label_sym = 0;
+                if (!S->feasible_YQ(x, numActive, S->bb_samples, label_sym, true) && label_sym > 0) {
+                    label = label_sym;
+                }
+            }
+        }
+    }
+
+
     ///////////////////////////////////////////////////////////////
     // CHECK IF IT IS WORTH TRYING OUT THE K-ADAPTABILITY BRANCH //
     ///////////////////////////////////////////////////////////////
@@ -4260,18 +4686,14 @@ static int CPXPUBLIC branchCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, v
         std::vector<std::vector<int> > cutind(K);
         std::vector<std::vector<double> > cutval(K);
         
-        // violated constraints
-        CPXDIM rcnt = 0;
-        CPXNNZ nzcnt;
-        std::vector<double> rhs;
-        std::vector<char> sense;
-        std::vector<CPXNNZ> rmatbeg;
-        std::vector<CPXDIM> rmatind;
-        std::vector<CPXDIM> rmatind_dd;
-        std::vector<double> rmatval;
+        // violated constraints (workspace is reused across calls)
+        static RowBatch rows;
+        static std::vector<CPXDIM> rmatind_dd;
         
-        if(DECISION_DEPENDENT)
-            S->getRobustYQ_fixedQ(S->bb_samples[label], rcnt, nzcnt, rhs, sense, rmatbeg, rmatind_dd, rmatval);;
+        if(DECISION_DEPENDENT) {
+            S->getRobustYQ_fixedQ(S->bb_samples[label], rows);
+            rmatind_dd.swap(rows.rmatind);
+        }
         
         for (unsigned int k = 0; k < K; k++) {
             auto xk = S->getXPolicy(x, K, k);
@@ -4285,33 +4707,21 @@ static int CPXPUBLIC branchCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, v
 //            std::vector<CPXDIM> rmatind;
 //            std::vector<double> rmatval;
             
-            if(DECISION_DEPENDENT){
-                if(K == 1)
-                    rmatind = rmatind_dd;
-                else
-                    rmatind = S->mapK(k, rmatind_dd);
-            }
+            if(DECISION_DEPENDENT)
+                S->mapK(k, rmatind_dd, rows.rmatind);
             else
-                S->getYQ_fixedQ(k, S->bb_samples[label], rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
+                S->getYQ_fixedQ(k, S->bb_samples[label], rows);
 
             // Add only the most violated constraint
             double maxViol = 0;
-            for (CPXDIM i = 0; i < rcnt; i++) {
-
-                // coefficients and indices of this constraint
-                CPXDIM next = (i + 1 == rcnt) ? nzcnt : rmatbeg[i+1];
-                std::vector<int> cutind_i(rmatind.begin() + rmatbeg[i], rmatind.begin() + next);
-                std::vector<double> cutval_i(rmatval.begin() + rmatbeg[i], rmatval.begin() + next);
-
-                // check violation
-                const auto W = checkViol(env, cbdata, wherefrom, rhs[i], sense[i], cutind_i, cutval_i);
-                if (W.first > maxViol) {
-                    maxViol = W.first;
-                    rhs_cut[k] = rhs[i];
-                    sense_cut[k] = sense[i];
-                    cutind[k] = cutind_i;
-                    cutval[k] = cutval_i;
-                }
+            const auto W = mostViolatedRow(env, cbdata, wherefrom, rows);
+            if (W.first > maxViol) {
+                const CPXDIM i = W.second;
+                maxViol = W.first;
+                rhs_cut[k] = rows.rhs[i];
+                sense_cut[k] = rows.sense[i];
+                cutind[k].assign(rows.rmatind.begin() + rows.rowBegin(i), rows.rmatind.begin() + rows.rowEnd(i));
+                cutval[k].assign(rows.rmatval.begin() + rows.rowBegin(i), rows.rmatval.begin() + rows.rowEnd(i));
             }
 
             // Violation must exist
@@ -4759,15 +5169,8 @@ static int CPXPUBLIC branchCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, v
         assert(label);
         assert(label < (int)S->bb_samples.size());
         
-        // violated constraints
-        CPXDIM rcnt = 0;
-        CPXNNZ nzcnt;
-        std::vector<double> rhs;
-        std::vector<char> sense;
-        std::vector<CPXNNZ> rmatbeg;
-        std::vector<CPXDIM> rmatind;
-        std::vector<CPXDIM> rmatind_dd;
-        std::vector<double> rmatval;
+        // violated constraints (workspace is reused across calls)
+        static RowBatch rows;
         
 //        if(DECISION_DEPENDENT){
 //            S->getRobustYQ_fixedQ(S->bb_samples[label], rcnt, nzcnt, rhs, sense, rmatbeg, rmatind_dd, rmatval);
@@ -4797,13 +5200,13 @@ static int CPXPUBLIC branchCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, v
                 samples_k.emplace_back(S->bb_samples[label]);
                 
                 S->feasible_RobustYQ(xk, samples_k, q, labelCstr, labelq);
-                S->getYQ_fixedQ(k, q, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
+                S->getYQ_fixedQ(k, q, rows);
                 
                 // update the samples in bb_samples_all, this is the first sample corresponding with the lable-th sample in bb_samples
                 S->bb_samples_all[label].emplace_back(q);
             }
             else
-                S->getYQ_fixedQ(k, S->bb_samples[label], rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
+                S->getYQ_fixedQ(k, S->bb_samples[label], rows);
 
 
 
@@ -4814,22 +5217,14 @@ static int CPXPUBLIC branchCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, v
                 std::vector<char> sense_cut = {'L'};
                 std::vector<int> cutind;
                 std::vector<double> cutval;
-                for (CPXDIM i = 0; i < rcnt; i++) {
-
-                    // coefficients and indices of this constraint
-                    CPXDIM next = (i + 1 == rcnt) ? nzcnt : rmatbeg[i+1];
-                    std::vector<int> cutind_i(rmatind.begin() + rmatbeg[i], rmatind.begin() + next);
-                    std::vector<double> cutval_i(rmatval.begin() + rmatbeg[i], rmatval.begin() + next);
-
-                    // check violation
-                    const auto W = checkViol(env, cbdata, wherefrom, rhs[i], sense[i], cutind_i, cutval_i);
-                    if (W.first > maxViol) {
-                        maxViol = W.first;
-                        rhs_cut[0] = rhs[i];
-                        sense_cut[0] = sense[i];
-                        cutind = cutind_i;
-                        cutval = cutval_i;
-                    }
+                const auto W = mostViolatedRow(env, cbdata, wherefrom, rows);
+                if (W.first > maxViol) {
+                    const CPXDIM i = W.second;
+                    maxViol = W.first;
+                    rhs_cut[0] = rows.rhs[i];
+                    sense_cut[0] = rows.sense[i];
+                    cutind.assign(rows.rmatind.begin() + rows.rowBegin(i), rows.rmatind.begin() + rows.rowEnd(i));
+                    cutval.assign(rows.rmatval.begin() + rows.rowBegin(i), rows.rmatval.begin() + rows.rowEnd(i));
                 }
 
                 // Violation must exist
@@ -4842,11 +5237,11 @@ static int CPXPUBLIC branchCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, v
                 #endif
 
                 // Create branch
-                CPXXbranchcallbackbranchconstraints(env, cbdata, wherefrom, 1, cutind.size(), &rhs_cut[0], &sense_cut[0], &rmatbeg[0], &cutind[0], &cutval[0], newInfo->nodeObjective, newInfo, &seqnum);
+                CPXXbranchcallbackbranchconstraints(env, cbdata, wherefrom, 1, cutind.size(), &rhs_cut[0], &sense_cut[0], rows.rmatbeg.data(), &cutind[0], &cutval[0], newInfo->nodeObjective, newInfo, &seqnum);
             }
             // Add all constraints
             else {
-                CPXXbranchcallbackbranchconstraints(env, cbdata, wherefrom, rcnt, nzcnt, &rhs[0], &sense[0], &rmatbeg[0], &rmatind[0], &rmatval[0], newInfo->nodeObjective, newInfo, &seqnum);
+                CPXXbranchcallbackbranchconstraints(env, cbdata, wherefrom, rows.rcnt, rows.nzcnt, rows.rhs.data(), rows.sense.data(), rows.rmatbeg.data(), rows.rmatind.data(), rows.rmatval.data(), newInfo->nodeObjective, newInfo, &seqnum);
             }
         }
 
@@ -4921,9 +5316,26 @@ static int CPXPUBLIC cutCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, void
     ///////////////////////////////////////////////////////////////////////////
     // assert(S->feasible_XQ(x, Q_TEMP));
     
+    if (USE_CUT_POOL) {
+        if (S->cutPool->nextRound() % CUT_POOL_PURGE_FREQ == 0) S->cutPool->purge(CUT_POOL_PURGE_AGE);
+    }
 
     // construct policy k solution
     for (unsigned int k = 0; k < K; k++) {
+        if (nodeInfo->labels[k].empty()) continue;
+
+        // first try to reuse a cut generated at another node for the same (policy, scenario)
+        if (USE_CUT_POOL) {
+            const auto cut = S->cutPool->findViolated(k, nodeInfo->labels[k], x, EPS_INFEASIBILITY_Q);
+            if (cut) {
+                CPXXcutcallbackaddlocal(env, cbdata, wherefrom, cut->ind.size(), cut->rhs, cut->sense, &cut->ind[0], &cut->val[0]);
+                // same bookkeeping as for a newly separated cut (scenario weights of the label, see solve_KAdaptability)
+                if (!cut->scenario.empty()) S->bb_samples_all[cut->label].emplace_back(cut->scenario);
+                *useraction_p = CPX_CALLBACK_SET;
+                continue;
+            }
+        }
+
         auto xk = S->getXPolicy(x, K, k);
 
         // scenarios that xk must insure against
@@ -4938,61 +5350,54 @@ static int CPXPUBLIC cutCB_solve_KAdaptability_cuttingPlane(CPXCENVptr env, void
         
         if (samples_k.empty()) continue;
         
-        // violated cuts
-        CPXDIM rcnt = 0;
+        // violated cuts (workspace is reused across calls)
+        static RowBatch rows;
         CPXNNZ nzcnt;
-        std::vector<double> rhs;
-        std::vector<char> sense;
-        std::vector<CPXNNZ> rmatbeg;
-        std::vector<CPXDIM> rmatind;
-        std::vector<double> rmatval;
         
-        // violated q and constraint label
-        std::vector<double> q;
-        int labelCstr;
-        int labelq;
+        // violated q and constraint labels (most violated constraint of up to SEPARATION_TOP_M scenarios)
+        std::vector<std::vector<double> > qs;
+        std::vector<int> labelCstrs;
+        std::vector<int> labelqs;
 
         // check constraints (x, y, q)
-        if(S->feasible_RobustYQ(xk, samples_k, q, labelCstr, labelq)){
+        if(S->feasible_RobustYQ(xk, samples_k, SEPARATION_TOP_M, qs, labelCstrs, labelqs)){
             assert(S->feasible_YQ(xk, 1, samples_k, label));
         }
-        else{
+        else for (unsigned int v = 0; v < qs.size(); v++) {
+            const auto& q = qs[v];
+            const int labelq = labelqs[v];
+
             // Add only the most violated constraint
             double maxViol = 0;
             double rhs_cut = 0;
             char sense_cut = 'L';
+            int cstr_cut = labelCstrs[v];
             std::vector<int> cutind;
             std::vector<double> cutval;
             
             if(GET_MAX_VIOL){
-                S->getSingleYQ_fixedQ(k, labelCstr, q, nzcnt, rhs_cut, sense_cut, cutind, cutval);
+                S->getSingleYQ_fixedQ(k, labelCstrs[v], q, nzcnt, rhs_cut, sense_cut, cutind, cutval);
                 maxViol = q[0];
             }
             else{
                 
-                S->getYQ_fixedQ(k, q, rcnt, nzcnt, rhs, sense, rmatbeg, rmatind, rmatval);
+                S->getYQ_fixedQ(k, q, rows);
                 
-                for (CPXDIM i = 0; i < rcnt; i++) {
-
-                    // coefficients and indices of this constraint
-                    CPXDIM next = (i + 1 == rcnt) ? nzcnt : rmatbeg[i+1];
-                    std::vector<int> cutind_i(rmatind.begin() + rmatbeg[i], rmatind.begin() + next);
-                    std::vector<double> cutval_i(rmatval.begin() + rmatbeg[i], rmatval.begin() + next);
-
-                    // check violation
-                    const auto W = checkViol(env, cbdata, wherefrom, rhs[i], sense[i], cutind_i, cutval_i);
-                    if (W.first > maxViol) {
-                        maxViol = W.first;
-                        rhs_cut = rhs[i];
-                        sense_cut = sense[i];
-                        cutind = cutind_i;
-                        cutval = cutval_i;
-                    }
+                const auto W = mostViolatedRow(env, cbdata, wherefrom, rows);
+                if (W.first > maxViol) {
+                    const CPXDIM i = W.second;
+                    maxViol = W.first;
+                    rhs_cut = rows.rhs[i];
+                    sense_cut = rows.sense[i];
+                    cstr_cut = i;
+                    cutind.assign(rows.rmatind.begin() + rows.rowBegin(i), rows.rmatind.begin() + rows.rowEnd(i));
+                    cutval.assign(rows.rmatval.begin() + rows.rowBegin(i), rows.rmatval.begin() + rows.rowEnd(i));
                 }
             }
             // Add local cut
             if (maxViol > EPS_INFEASIBILITY_Q) {
                 CPXXcutcallbackaddlocal(env, cbdata, wherefrom, cutind.size(), rhs_cut, sense_cut, &cutind[0], &cutval[0]);
+                if (USE_CUT_POOL) S->cutPool->add(k, nodeInfo->labels[k][labelq], cstr_cut, rhs_cut, sense_cut, cutind, cutval, q);
                 S->bb_samples_all[nodeInfo->labels[k][labelq]].emplace_back(q);
                 //std::cout << "here! add constraints for violation!" << k << std::endl;
                 *useraction_p = CPX_CALLBACK_SET;
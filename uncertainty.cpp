@@ -23,10 +23,43 @@
 
 #include "uncertainty.hpp"
 #include "Constants.h"
+#include "modelNames.hpp"
 #include <cassert>
 #include <iostream>
 #include <algorithm> // std::transform
 #include <numeric>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// Maximize linear functions over box, budgeted and factor-model sets in closed form
+const bool USE_CLOSED_FORM_MAX = 1;
+
+// Cache results of separation problems (data are rounded to multiples of SEPARATION_CACHE_ROUND)
+const bool   USE_SEPARATION_CACHE   = 1;
+const double SEPARATION_CACHE_ROUND = 1.E-9;
+
+// Solve small LPs over the set with the built-in dense simplex before CPLEX (all backends solve every LP and are compared if requested);
+// at the limits below a dense solve takes 1-2 ms, and its time grows about with the cube of the size (see bench/bench_dense.cpp)
+const bool USE_DENSE_SIMPLEX         = 1;
+const bool CROSSCHECK_LP_BACKENDS    = 0;
+const int  DENSE_SIMPLEX_MAX_ROWS    = 50;      // max # of rows of the reduced LP
+const long DENSE_SIMPLEX_MAX_ENTRIES = 1L << 13; // max # of tableau entries
+
+// Status of an LP that a backend did not attempt or could not solve (not a CPLEX status, see solveLP)
+const int LP_NOT_SOLVED = 0;
+
+// Last revision number assigned to an uncertainty set
+static unsigned long LAST_REVISION = 0;
+
+//---------------------------------------------------------------------------//
+
+static inline long long roundForCache(const double v) {
+	if (std::abs(v) < 1.E9) return std::llround(v / SEPARATION_CACHE_ROUND);
+	long long bits;
+	std::memcpy(&bits, &v, sizeof(bits));
+	return bits;
+}
 
 //---------------------------------------------------------------------------//
 
@@ -58,49 +91,32 @@ static inline void initCPX(CPXENVptr& env) {
 
 //---------------------------------------------------------------------------//
 
-UncertaintySet::UncertaintySet() {
+struct UncertaintySet::SolverEnv {
+	CPXENVptr env;
 
-	int status;
-
-	// Initialize members
-	N = 0;
-	nominal.reserve(1000);
-	nominal.emplace_back(0);
-	low = nominal;
-	high = nominal;
-
-	polytope_W.emplace_back(std::vector<double>(1, 0));
-	polytope_V.emplace_back(std::vector<double>(1, 0));
-	polytope_h.emplace_back(0);
-	polytope_sense.emplace_back('L');
-    obsVar.clear();
-    w.clear();
-
-
-	// initialize CPLEX objects
-	env = NULL;
-	lp  = NULL;
-	initCPX(env);
-
-	// Create problem object/model
-	lp = CPXXcreateprob(env, &status, "UncertaintySet");
-	if (!lp) throw(EXCEPTION_CPXINIT);
+	SolverEnv() : env(NULL) { initCPX(env); }
 
-	// Create objective function variable
-	const double obj    = 1;
-	const double lo     = -CPX_INFBOUND;
-	const double hi     = +CPX_INFBOUND;
-	const char xctype   = 'C';
-	const char *colname = "O";
-	if (CPXXnewcols(env, lp, 1, &obj, &lo, &hi, &xctype, &colname)) {
-		throw(EXCEPTION_CPXNEWCOLS);
+	~SolverEnv() {
+		if (env) if (CPXXcloseCPLEX(&env)) {
+			std::cerr << "Error: Could not close solver environment of uncertainty sets.\n";
+		}
 	}
+};
 
-	// Make it linear
-	CPXXchgprobtype(env, lp, CPXPROB_LP);
+//---------------------------------------------------------------------------//
 
-	// Make it a maximization problem
-	CPXXchgobjsen(env, lp, CPX_MAX);
+UncertaintySet::UncertaintySet() :
+	N(0),
+	geom(std::make_shared<Geometry>()),
+	polytope_h(std::make_shared<std::vector<double> >(1, 0.0)),
+	env(NULL),
+	lp(NULL),
+	sepCache(MAX_SEPARATION_CACHE)
+{
+	structure = STRUCT_UNKNOWN;
+	revision = ++LAST_REVISION;
+	structureRevision = revision;
+	boundsDirty = false;
 }
 
 
@@ -109,29 +125,18 @@ UncertaintySet::UncertaintySet() {
 
 UncertaintySet::UncertaintySet(const UncertaintySet& U) :
 	N(U.N),
-	nominal(U.nominal),
-	low(U.low),
-	high(U.high),
-	polytope_W(U.polytope_W),
-	polytope_V(U.polytope_V),
+	geom(U.geom),
 	polytope_h(U.polytope_h),
-	polytope_sense(U.polytope_sense),
-    w(U.w),
-    obsVar(U.obsVar)
+	w(U.w),
+	env(NULL),
+	lp(NULL),
+	sepCache(MAX_SEPARATION_CACHE),
+	structure(STRUCT_UNKNOWN)
 {
-	int status;
-
-	// Try to initialize solver environment
-	env = NULL;
-	lp  = NULL;
-	initCPX(env);
-
-
-	// Copy solver model object
-	lp = U.getLPObject(env, &status);
-	if (status) {
-		throw(EXCEPTION_CPXINIT);
-	}
+	// parameters and facets are shared until either set is modified; solver objects are built when needed
+	revision = ++LAST_REVISION;
+	structureRevision = U.structureRevision;
+	boundsDirty = false;
 }
 
 //---------------------------------------------------------------------------//
@@ -142,33 +147,18 @@ UncertaintySet& UncertaintySet::operator=(const UncertaintySet& U) {
 		return *this;
 	}
 
+	// delete solver objects, separation LPs and cached results
+	freeSolverLP();
+	sepCache.clear();
+	structure = STRUCT_UNKNOWN;
+
 	N = U.N;
-	nominal = U.nominal;
-	low = U.low;
-	high = U.high;
-	polytope_W = U.polytope_W;
-	polytope_V = U.polytope_V;
+	geom = U.geom;
 	polytope_h = U.polytope_h;
-	polytope_sense = U.polytope_sense;
-    w = U.w;
-    obsVar = U.obsVar;
+	w = U.w;
 
-	int status;
-
-	// env, lp are already allocated
-	assert(env);
-	assert(lp);
-
-	// delete lp
-	if (lp) if (CPXXfreeprob (env, &lp)) {
-		throw(EXCEPTION_CPXEXIT);
-	}
-
-	// Copy solver model object
-	lp = U.getLPObject(env, &status);
-	if (status) {
-		throw(EXCEPTION_CPXINIT);
-	}
+	revision = ++LAST_REVISION;
+	structureRevision = U.structureRevision;
 
 	return *this;
 }
@@ -180,68 +170,117 @@ UncertaintySet& UncertaintySet::operator=(const UncertaintySet& U) {
 
 
 UncertaintySet::~UncertaintySet() noexcept(false) {
-	this->clear();
+	// Free problem objects (the environment is closed along with the last set using it)
+	freeSolverLP();
+}
 
-	assert(env);
-	assert(lp);
 
-	// Free problem object memory
-	if (lp) if (CPXXfreeprob(env, &lp)) {
-		throw(EXCEPTION_CPXEXIT);
-	}
-	
+//---------------------------------------------------------------------------//
 
-	// Free solver memory
-	if (env) if (CPXXcloseCPLEX(&env)) {
-		char  errmsg[CPXMESSAGEBUFSIZE];
-		int status = 0;
-		CPXXgeterrorstring (env, status, errmsg);
-		std::cerr << errmsg << std::endl;
-		throw(EXCEPTION_CPXEXIT);
-	}
+void UncertaintySet::clear() {
+	// solver objects, separation LPs, cached results and structure are no longer valid
+	freeSolverLP();
+	sepCache.clear();
+	structure = STRUCT_UNKNOWN;
+	revision = ++LAST_REVISION;
+	structureRevision = revision;
+
+	// Zero all members
+	N = 0;
+	geom = std::make_shared<Geometry>();
+	polytope_h = std::make_shared<std::vector<double> >(1, 0.0);
+	w.clear();
 }
 
+//---------------------------------------------------------------------------//
+
+UncertaintySet::Geometry& UncertaintySet::mutableGeometry() {
+	if (geom.use_count() > 1) geom = std::make_shared<Geometry>(*geom);
+	return *geom;
+}
 
 //---------------------------------------------------------------------------//
 
-void UncertaintySet::clear() {
-	assert(env);
-	assert(lp);
+std::vector<double>& UncertaintySet::mutableRHS() {
+	if (polytope_h.use_count() > 1) polytope_h = std::make_shared<std::vector<double> >(*polytope_h);
+	return *polytope_h;
+}
+
+//---------------------------------------------------------------------------//
 
-	// get # of cols
-	const int cur_numcols = CPXXgetnumcols(env, lp);
+CPXLPptr UncertaintySet::getSolverLP() const {
+	if (lp) return lp;
 
-	// delete all columns except the objective
-	assert(cur_numcols >= 1);
-	if (cur_numcols > 1) {
-		CPXXdelcols(env, lp, 1, CPXXgetnumcols(env, lp) - 1);
+	// environment: one per thread, shared by all sets
+	if (!envHandle) {
+		thread_local std::shared_ptr<SolverEnv> pool;
+		if (!pool) pool = std::make_shared<SolverEnv>();
+		envHandle = pool;
+		env = envHandle->env;
 	}
-	assert(CPXXgetnumcols(env, lp) == 1);
-    
-    // get # of rows
-    const int cur_numrows = CPXXgetnumrows(env, lp);
 
-    // delete all columns except the objective
-    assert(cur_numrows >= 0);
-    if (cur_numrows > 0) {
-        CPXXdelrows(env, lp, 0, CPXXgetnumrows(env, lp) - 1);
-    }
-    assert(CPXXgetnumrows(env, lp) == 0);
-    
-	// set default options
-	setCPXoptions(env);
-	
-	// Zero all members
-	N    = 0;
-	nominal.assign(1, 0.0);
-	low  = nominal;
-	high = nominal;
-	polytope_W.assign(1, std::vector<double>(1, 0));
-	polytope_V.assign(1, std::vector<double>(1, 0));
-	polytope_h.assign(1, 0.0);
-	polytope_sense.assign(1, 'L');
-    obsVar.clear();
-    w.clear();
+	int status;
+	lp = CPXXcreateprob(env, &status, "UncertaintySet");
+	if (!lp) throw(EXCEPTION_CPXINIT);
+
+	const Geometry& G = *geom;
+	const std::vector<double>& h = *polytope_h;
+
+	// Objective function variable and uncertain parameters (current bounds of observed parameters, see syncBounds)
+	std::vector<double> obj(1 + N, 0), lb(1 + N), ub(1 + N);
+	std::vector<char> xctype(1 + N, 'C');
+	std::vector<std::string> cname(1 + N);
+	obj[0] = 1;
+	lb[0]  = -CPX_INFBOUND;
+	ub[0]  = +CPX_INFBOUND;
+	cname[0] = modelName("O");
+	for (int i = 1; i <= N; ++i) {
+		const bool observed = (i <= (int)w.size() && w[i-1]);
+		lb[i] = observed ? h[2*i] : G.low[i];
+		ub[i] = observed ? h[2*i - 1] : G.high[i];
+		cname[i] = modelName("q", i);
+	}
+	std::vector<const char*> colname; if (NAME_MODEL_ELEMENTS) for (const auto& c : cname) colname.push_back(c.c_str());
+	if (CPXXnewcols(env, lp, 1 + N, &obj[0], &lb[0], &ub[0], &xctype[0], colname.empty() ? NULL : &colname[0])) {
+		throw(EXCEPTION_CPXNEWCOLS);
+	}
+
+	// Facets
+	if (!G.facetRows.empty()) {
+		std::vector<CPXNNZ> rmatbeg;
+		std::vector<CPXDIM> rmatind;
+		std::vector<double> rmatval, rhs;
+		std::vector<char> sense;
+		for (const int r : G.facetRows) {
+			const RowView W = getRowW(r);
+			rmatbeg.emplace_back(rmatind.size());
+			rmatind.insert(rmatind.end(), W.ind, W.ind + W.nnz);
+			rmatval.insert(rmatval.end(), W.val, W.val + W.nnz);
+			rhs.emplace_back(h[r]);
+			sense.emplace_back(G.polytope_sense[r]);
+		}
+		if (CPXXaddrows(env, lp, 0, rhs.size(), rmatind.size(), &rhs[0], &sense[0], &rmatbeg[0], rmatind.data(), rmatval.data(), nullptr, NULL))
+			throw(EXCEPTION_CPXNEWROWS);
+	}
+
+	// Make it a linear maximization problem
+	CPXXchgprobtype(env, lp, CPXPROB_LP);
+	CPXXchgobjsen(env, lp, CPX_MAX);
+
+	boundsDirty = false;
+
+	return lp;
+}
+
+//---------------------------------------------------------------------------//
+
+void UncertaintySet::freeSolverLP() const {
+	freeSeparationLPs();
+	if (lp) if (CPXXfreeprob(env, &lp)) {
+		throw(EXCEPTION_CPXEXIT);
+	}
+	lp = NULL;
+	boundsDirty = false;
 }
 
 //---------------------------------------------------------------------------//
@@ -256,52 +295,45 @@ void UncertaintySet::addParam(const double nom, const double lo, const double hi
 	if (nom > hi)
 		std::cerr << "Warning. Nominal value of uncertain parameter is greater than the upper bound.\n";
 
+	Geometry& G = mutableGeometry();
+	std::vector<double>& h = mutableRHS();
+
 	N++;
-	nominal.emplace_back(nom);
-	low.emplace_back(lo);
-	high.emplace_back(hi);
+	G.nominal.emplace_back(nom);
+	G.low.emplace_back(lo);
+	G.high.emplace_back(hi);
 
-	assert(nominal.size() == low.size());
-	assert(high.size() == low.size());
-	assert(1 + N == (int)low.size());
+	assert(G.nominal.size() == G.low.size());
+	assert(G.high.size() == G.low.size());
+	assert(1 + N == (int)G.low.size());
 
 
-	// update matrices
-	for (unsigned i = 0; i < polytope_W.size(); ++i) {
-		polytope_W[i].emplace_back(0);
-		assert((int)polytope_W[i].size() == 1 + N);
-	}
+	// update matrices (existing rows do not involve the new parameter)
+	const double one = 1;
 
 	// Upper bound
-	polytope_W.emplace_back(std::vector<double>(1 + N, 0));
-	polytope_V.emplace_back(std::vector<double>(1, 0));
-	polytope_W.back().back() = 1;
-	polytope_sense.emplace_back('L');
-	polytope_h.emplace_back(hi);
+	G.appendRowW(1, &N, &one);
+	G.polytope_sense.emplace_back('L');
+	h.emplace_back(hi);
 
 	// Lower bound
-	polytope_W.emplace_back(std::vector<double>(1 + N, 0));
-	polytope_V.emplace_back(std::vector<double>(1, 0));
-	polytope_W.back().back() = 1;
-	polytope_sense.emplace_back('G');
-	polytope_h.emplace_back(lo);
+	G.appendRowW(1, &N, &one);
+	G.polytope_sense.emplace_back('G');
+	h.emplace_back(lo);
     
     // Initialize the observation decision vector
-    obsVar.emplace_back(-1);
+    G.obsVar.emplace_back(-1);
+
+	// solver objects, separation LPs, cached results and structure are no longer valid
+	freeSolverLP();
+	sepCache.clear();
+	structure = STRUCT_UNKNOWN;
+	revision = ++LAST_REVISION;
+	structureRevision = revision;
     
 	// Matrix sizes must match
-	assert(polytope_h.size() == polytope_sense.size());
-	assert(polytope_W.size() == polytope_sense.size());
-	assert(polytope_V.size() == polytope_sense.size());
-
-	// Add variable to solver model object
-	double obj = 0;
-	const char xctype = 'C';
-	const char *colname = std::string("q(" + std::to_string(N) + ")").c_str();
-	if (CPXXnewcols(env, lp, 1, &obj, &lo, &hi, &xctype, &colname)) {
-		throw(EXCEPTION_CPXNEWCOLS);
-	}
-	assert(CPXXgetnumcols(env, lp) == 1 + N);
+	assert(h.size() == G.polytope_sense.size());
+	assert(G.polytope_beg.size() == 1 + G.polytope_sense.size());
 
 	return;
 
@@ -320,22 +352,10 @@ void UncertaintySet::addFacet(const std::vector<std::pair<int, double> >& data,
 		}
 	}
 
-	// update matrices
-	polytope_W.emplace_back(std::vector<double>(1 + N, 0));
-	polytope_V.emplace_back(std::vector<double>(1, 0));
-	polytope_h.emplace_back(rhs);
-	polytope_sense.emplace_back(sense);
-
-	for (const auto& d : data)
-		polytope_W.back().at(d.first) = d.second;
-
-
-	// Matrix sizes must match
-	assert(polytope_h.size() == polytope_sense.size());
-	assert(polytope_W.size() == polytope_sense.size());
-	assert(polytope_V.size() == polytope_sense.size());
+	Geometry& G = mutableGeometry();
+	std::vector<double>& h = mutableRHS();
 
-	// Update solver model object
+	// update matrices
 	std::vector<int> indices;
 	std::vector<double> coeffs;
 
@@ -344,12 +364,22 @@ void UncertaintySet::addFacet(const std::vector<std::pair<int, double> >& data,
 		coeffs.emplace_back(d.second);
 	}
 
-	const std::string rname = "row(" + std::to_string(CPXXgetnumrows(env, lp) + 1) + ")";
-	const std::vector<const char*> rowname({rname.c_str()});
-	CPXNNZ rmatbeg = 0;
+	G.facetRows.emplace_back(h.size());
+	G.appendRowW(indices.size(), indices.data(), coeffs.data());
+	h.emplace_back(rhs);
+	G.polytope_sense.emplace_back(sense);
+
+	// solver objects, separation LPs, cached results and structure are no longer valid
+	freeSolverLP();
+	sepCache.clear();
+	structure = STRUCT_UNKNOWN;
+	revision = ++LAST_REVISION;
+	structureRevision = revision;
 
-	if (CPXXaddrows(env, lp, 0, 1, indices.size(), &rhs, &sense, &rmatbeg, &indices[0], &coeffs[0], nullptr, &rowname[0]))
-		throw(EXCEPTION_CPXNEWROWS);
+
+	// Matrix sizes must match
+	assert(h.size() == G.polytope_sense.size());
+	assert(G.polytope_beg.size() == 1 + G.polytope_sense.size());
 
 	return;
 }
@@ -358,20 +388,139 @@ void UncertaintySet::addFacet(const std::vector<std::pair<int, double> >& data,
 //---------------------------------------------------------------------------//
 
 
+void UncertaintySet::assign(const std::vector<double>& nom, const std::vector<double>& lo, const std::vector<double>& hi,
+                            const std::vector<int>& rowBeg, const std::vector<int>& rowInd, const std::vector<double>& rowVal,
+                            const std::vector<char>& sense, const std::vector<double>& rhs) {
+	assert(nom.size() == lo.size() && nom.size() == hi.size());
+	assert(rowBeg.size() == sense.size() && rowBeg.size() == rhs.size());
+	assert(rowInd.size() == rowVal.size());
+
+	clear();
+
+	const int n = nom.size();
+	for (int i = 0; i < n; ++i) {
+		if (nom[i] < lo[i])
+			std::cerr << "Warning. Nominal value of uncertain parameter is lower than the lower bound.\n";
+		if (nom[i] > hi[i])
+			std::cerr << "Warning. Nominal value of uncertain parameter is greater than the upper bound.\n";
+	}
+
+	Geometry& G = mutableGeometry();
+	std::vector<double>& h = mutableRHS();
+
+	// parameters and their bound rows
+	N = n;
+	G.nominal.insert(G.nominal.end(), nom.begin(), nom.end());
+	G.low.insert(G.low.end(), lo.begin(), lo.end());
+	G.high.insert(G.high.end(), hi.begin(), hi.end());
+	G.obsVar.assign(n, -1);
+
+	const int m = sense.size();
+	const double one = 1;
+	G.polytope_beg.reserve(2 + 2*n + m);
+	G.polytope_ind.reserve(2*n + rowInd.size());
+	G.polytope_val.reserve(2*n + rowVal.size());
+	G.polytope_sense.reserve(1 + 2*n + m);
+	G.facetRows.reserve(m);
+	h.reserve(1 + 2*n + m);
+	for (int i = 1; i <= n; ++i) {
+		G.appendRowW(1, &i, &one);
+		G.polytope_sense.emplace_back('L');
+		h.emplace_back(G.high[i]);
+		G.appendRowW(1, &i, &one);
+		G.polytope_sense.emplace_back('G');
+		h.emplace_back(G.low[i]);
+	}
+
+	// facets (invalid ones are skipped, as in addFacet)
+	for (int r = 0; r < m; ++r) {
+		const int beg = rowBeg[r];
+		const int end = (r + 1 < m) ? rowBeg[r + 1] : (int)rowInd.size();
+		bool valid = true;
+		for (int k = beg; k < end; ++k) if (rowInd[k] < 1 || rowInd[k] > N) valid = false;
+		if (!valid) {
+			std::cerr << "Warning: Facet description contains invalid indices of uncertain parameters. ";
+			std::cerr << "Will not add facet.\n";
+			continue;
+		}
+
+		G.facetRows.emplace_back(h.size());
+		G.appendRowW(end - beg, rowInd.data() + beg, rowVal.data() + beg);
+		h.emplace_back(rhs[r]);
+		G.polytope_sense.emplace_back(sense[r]);
+	}
+
+	revision = ++LAST_REVISION;
+	structureRevision = revision;
+
+	// Matrix sizes must match
+	assert(h.size() == G.polytope_sense.size());
+	assert(G.polytope_beg.size() == 1 + G.polytope_sense.size());
+}
+
+
+//---------------------------------------------------------------------------//
+
+
+void UncertaintySet::Geometry::appendRowW(const int nnz, const int* ind, const double* val) {
+	assert(polytope_beg.back() == (int)polytope_ind.size());
+	const int beg = polytope_ind.size();
+
+	// insertion sort by index; rows are short
+	for (int k = 0; k < nnz; ++k) {
+		int pos = polytope_ind.size();
+		while (pos > beg && polytope_ind[pos - 1] > ind[k]) --pos;
+		if (pos > beg && polytope_ind[pos - 1] == ind[k]) {
+			polytope_val[pos - 1] = val[k];
+			continue;
+		}
+		polytope_ind.insert(polytope_ind.begin() + pos, ind[k]);
+		polytope_val.insert(polytope_val.begin() + pos, val[k]);
+	}
+
+	// drop zeros
+	int end = beg;
+	for (int k = beg; k < (int)polytope_ind.size(); ++k) if (polytope_val[k] != 0.0) {
+		polytope_ind[end] = polytope_ind[k];
+		polytope_val[end] = polytope_val[k];
+		++end;
+	}
+	polytope_ind.resize(end);
+	polytope_val.resize(end);
+	polytope_beg.emplace_back(end);
+}
+
+
+//---------------------------------------------------------------------------//
+
+
+std::vector<std::vector<double> > UncertaintySet::getMatrixW() const {
+	std::vector<std::vector<double> > W(polytope_h->size(), std::vector<double>(1 + N, 0));
+	for (unsigned r = 1; r < polytope_h->size(); ++r) {
+		const RowView row = getRowW(r);
+		for (int k = 0; k < row.nnz; ++k) W[r][row.ind[k]] = row.val[k];
+	}
+	return W;
+}
+
+
+//---------------------------------------------------------------------------//
+
+
 int UncertaintySet::addVariables_DualVars(CPXCENVptr env_, CPXLPptr lp_, const std::string& dualName) const {
-	/* Assumes that polytope_W, polytope_V, polytope_h and polytope_sense
+	/* Assumes that polytope_beg, polytope_h and polytope_sense
 	 * have all been allocated and have the same number of rows.
 	 *
 	 * Assumes that these matrices/vectors are all 1-indexed.
 	 */
-	const CPXDIM ccnt = polytope_sense.size() - 1;
+	const CPXDIM ccnt = geom->polytope_sense.size() - 1;
 	const std::vector<double> obj(ccnt, 0);
 	const std::vector<char> xctype(ccnt, 'C');
 	std::vector<double> lb, ub;
 	std::vector<std::string> cname;
 	for (int s = 1; s <= ccnt; s++) {
-		cname.emplace_back("UncSetDual(" + (std::string)dualName + "," + std::to_string(s) + ")");
-		switch (polytope_sense.at(s)){
+		if (NAME_MODEL_ELEMENTS) cname.emplace_back(modelName("UncSetDual", dualName, s));
+		switch (geom->polytope_sense.at(s)){
 			case 'L': ub.push_back(+CPX_INFBOUND); lb.push_back(0);             break;
 			case 'G': ub.push_back(0);             lb.push_back(-CPX_INFBOUND); break;
 			case 'E': ub.push_back(+CPX_INFBOUND); lb.push_back(-CPX_INFBOUND); break;
@@ -380,7 +529,7 @@ int UncertaintySet::addVariables_DualVars(CPXCENVptr env_, CPXLPptr lp_, const s
 
 	/* ADD COLUMNS TO CPLEX */
 	std::vector<const char*> colname; for (size_t i = 0; i<cname.size(); i++) colname.push_back(cname[i].c_str());
-	if (CPXXnewcols(env_, lp_, ccnt, &obj[0], &lb[0], &ub[0], &xctype[0], &colname[0]))
+	if (CPXXnewcols(env_, lp_, ccnt, &obj[0], &lb[0], &ub[0], &xctype[0], colname.empty() ? NULL : &colname[0]))
 		throw(EXCEPTION_CPXNEWCOLS);
 
 	return ccnt;
@@ -394,18 +543,25 @@ void UncertaintySet::setW(const std::vector<bool>& wInput){
 //    }
     std::vector<bool> newW(N, 0);
     for(int i = 0; i < N; i++){
-        if(obsVar[i] >= 0){
-            newW[i] = wInput[obsVar[i]];
+        if(geom->obsVar[i] >= 0){
+            newW[i] = wInput[geom->obsVar[i]];
         }
     }
+    if (newW == w) return;
     
     w = newW;
+
+    // bounds of parameters that are no longer observed must be restored, and cached results
+    // were computed for the previous observation pattern
+    freeSolverLP();
+    sepCache.clear();
+    revision = ++LAST_REVISION;
 }
 
 
 void UncertaintySet::setObsVar(const std::pair<int, int>& obsVarInput){
     assert(obsVarInput.first <= N);
-    obsVar[obsVarInput.first-1] = obsVarInput.second;
+    mutableGeometry().obsVar[obsVarInput.first-1] = obsVarInput.second;
 }
 
 
@@ -419,20 +575,20 @@ void UncertaintySet::setXiBar(const std::vector<double>& xi_bar_sample){
         std::cout << "Wrong size of xi_bar vector!" << std::endl;
         assert(0);
     }
+    revision = ++LAST_REVISION;
+
     // update upper bound and lower bound
-    char lb = 'L'; char ub = 'U';
-    double val;
+    std::vector<double>& h = mutableRHS();
     for (int i = 1; i <= N; ++i){
         if(w[i-1]){
-            val = xi_bar_sample[i];
-            assert(val <= high[i] + 0.0001);
-            assert(val >= low[i] - 0.0001);
-            polytope_h[2*i - 1] = val;
-            polytope_h[2*i] = val;
-            CPXXchgbds(env, lp, 1, &i, &lb, &val);
-            CPXXchgbds(env, lp, 1, &i, &ub, &val);
+            const double val = xi_bar_sample[i];
+            assert(val <= geom->high[i] + 0.0001);
+            assert(val >= geom->low[i] - 0.0001);
+            h[2*i - 1] = val;
+            h[2*i] = val;
         }
     }
+    boundsDirty = true;
 }
 
 void UncertaintySet::resetXiBar(){
@@ -440,17 +596,43 @@ void UncertaintySet::resetXiBar(){
     if(!getWSize())
         return;
 
+    revision = ++LAST_REVISION;
+
     // set back upper bound and lower bound
-    char lb = 'L'; char ub = 'U';
+    std::vector<double>& h = mutableRHS();
     for (int i = 1; i <= N; ++i){
         if(w[i-1]){
             // Assume that first upper bound, then lower bound
-            polytope_h[2*i - 1] = high[i];
-            polytope_h[2*i] = low[i];
-            CPXXchgbds(env, lp, 1, &i, &lb, &low[i]);
-            CPXXchgbds(env, lp, 1, &i, &ub, &high[i]);
+            h[2*i - 1] = geom->high[i];
+            h[2*i] = geom->low[i];
         }
     }
+    boundsDirty = true;
+}
+
+void UncertaintySet::syncBounds() const {
+    if (!boundsDirty) return;
+    boundsDirty = false;
+
+    // solver objects that are not built yet will get the current bounds (see getSolverLP)
+    if (!lp) return;
+
+    std::vector<CPXDIM> indices;
+    std::vector<char> lu;
+    std::vector<double> bd;
+    for (int i = 1; i <= (int)w.size(); ++i){
+        if(w[i-1]){
+            indices.insert(indices.end(), {i, i});
+            lu.insert(lu.end(), {'L', 'U'});
+            bd.insert(bd.end(), {(*polytope_h)[2*i], (*polytope_h)[2*i - 1]});
+        }
+    }
+    if (indices.empty()) return;
+
+    CPXXchgbds(env, lp, indices.size(), &indices[0], &lu[0], &bd[0]);
+    for (auto& sep : sepLP) {
+        CPXXchgbds(env, sep.second, indices.size(), &indices[0], &lu[0], &bd[0]);
+    }
 }
 
 //---------------------------------------------------------------------------//
@@ -460,7 +642,6 @@ double UncertaintySet::max(const std::vector<std::pair<int, double> >& data, std
 	
 	if(N == 0) return 0;
 
-	int probtype = CPXXgetprobtype(env, lp);
 	std::vector<int> indices;
 	std::vector<double> coeffs;
 
@@ -473,34 +654,20 @@ double UncertaintySet::max(const std::vector<std::pair<int, double> >& data, std
 	// return value
 	double val = 0; result.assign(1 + N, 0);
 
-	// Set objective function of LP over the uncertainty set
-	std::vector<CPXDIM> CplexIndices(1 + N, 0);
+	// Objective function of LP over the uncertainty set
 	std::vector<double> values(1 + N, 0);
-	std::iota(CplexIndices.begin(), CplexIndices.end(), 0);
 	for (unsigned i = 0; i < indices.size(); ++i) {
 		values.at(indices.at(i)) = coeffs.at(i);
 	}
 
-	// Replace current objective function
-	CPXXchgobj(env, lp, (CPXDIM)CplexIndices.size(), &CplexIndices[0], &values[0]);
-
-	// Set objective sense
-	CPXXchgobjsen(env, lp, CPX_MAX);
-
-	
-	// Solve MILP/LP
-	switch(probtype) {
-		case CPXPROB_LP: CPXXlpopt(env, lp); assert(CPXXgetstat(env, lp) == CPX_STAT_OPTIMAL); break;
-		case CPXPROB_MILP: CPXXmipopt(env, lp); assert(CPXXgetstat(env, lp) == CPXMIP_OPTIMAL || CPXXgetstat(env, lp) == CPXMIP_OPTIMAL_TOL); break;
+	// Avoid the LP if possible
+	if (USE_CLOSED_FORM_MAX && values[0] == 0.0 && maxClosedForm(values, result, val)) {
+		return val;
 	}
 
-
-	// Get optimal value
-	CPXXgetobjval(env, lp, &val);
-	
-	// Get solution vector
-	CPXXgetx(env, lp, &result[0], 0, N);
-	
+	// Solve LP
+	const int lpstat = solveLP(values, {}, {}, {}, result, val);
+	assert(lpstat == CPX_STAT_OPTIMAL);
 
 	return val;
 }
@@ -534,16 +701,732 @@ double UncertaintySet::getMaximumValue(const std::vector<int>& ind, const std::v
 	return UncertaintySet::max(input, result);
 }
 
+//---------------------------------------------------------------------------//
+
+void UncertaintySet::freeSeparationLPs() const {
+	for (auto& sep : sepLP) {
+		if (sep.second) if (CPXXfreeprob(env, &sep.second)) {
+			throw(EXCEPTION_CPXEXIT);
+		}
+	}
+	sepLP.clear();
+}
+
+//---------------------------------------------------------------------------//
+
+int UncertaintySet::solveSeparationLP(const std::vector<std::vector<int> >& ind, const std::vector<std::vector<double> >& val, const std::vector<double>& rhs, std::vector<double>& result) const {
+	assert(ind.size() == val.size());
+	assert(ind.size() == rhs.size());
+
+	const CPXDIM numrows = ind.size();
+
+	// Look up the cache: rows, observed parameters and their current bounds (see setW, setXiBar)
+	std::vector<long long>& key = sepKey;
+	key.clear();
+	if (USE_SEPARATION_CACHE) {
+		key.emplace_back(numrows);
+		for (CPXDIM p = 0; p < numrows; ++p) {
+			key.emplace_back(ind[p].size());
+			key.insert(key.end(), ind[p].begin(), ind[p].end());
+			for (const auto& v : val[p]) key.emplace_back(roundForCache(v));
+			key.emplace_back(roundForCache(rhs[p]));
+		}
+		for (int i = 1; i <= (int)w.size(); ++i) if (w[i-1]) {
+			key.emplace_back(i);
+			key.emplace_back(roundForCache((*polytope_h)[2*i - 1]));
+			key.emplace_back(roundForCache((*polytope_h)[2*i]));
+		}
+		const auto cached = sepCache.find(key);
+		if (cached) {
+			result = *cached;
+			return CPX_STAT_OPTIMAL;
+		}
+	}
+
+	// Single row: max tau = (rhs - val'q) / val(tau) can be computed in closed form
+	if (USE_CLOSED_FORM_MAX && numrows == 1 && !ind[0].empty() && ind[0][0] == 0 && val[0][0] > 0) {
+		std::vector<double>& coef = sepCoef;
+		coef.assign(1 + N, 0.0);
+		for (unsigned i = 1; i < ind[0].size(); ++i) coef.at(ind[0][i]) = -val[0][i];
+		double maxval;
+		if (maxClosedForm(coef, result, maxval)) {
+			result[0] = (rhs[0] + maxval) / val[0][0];
+			if (USE_SEPARATION_CACHE) sepCache.insert(key, result);
+			return CPX_STAT_OPTIMAL;
+		}
+	}
+
+	// Solve LP: max tau
+	std::vector<double>& obj = sepCoef;
+	obj.assign(1 + N, 0.0);
+	obj[0] = 1.0;
+	double tau;
+	const int lpstat = solveLP(obj, ind, val, rhs, result, tau);
+	if (lpstat == CPX_STAT_OPTIMAL) {
+		result[0] = tau;
+		if (USE_SEPARATION_CACHE) sepCache.insert(key, result);
+	}
+
+	return lpstat;
+}
+
+
+//---------------------------------------------------------------------------//
+
+class UncertaintySet::DenseBackend : public UncertaintySet::LPBackend {
+public:
+	const char* name() const { return "dense simplex"; }
+
+	int solve(const UncertaintySet& U, const std::vector<double>& obj, const std::vector<std::vector<int> >& ind, const std::vector<std::vector<double> >& val, const std::vector<double>& rhs, std::vector<double>& result, double& objval) const {
+		return U.solveDenseLP(obj, ind, val, rhs, result, objval) ? CPX_STAT_OPTIMAL : LP_NOT_SOLVED;
+	}
+};
+
+class UncertaintySet::CplexBackend : public UncertaintySet::LPBackend {
+public:
+	const char* name() const { return "CPLEX"; }
+
+	int solve(const UncertaintySet& U, const std::vector<double>& obj, const std::vector<std::vector<int> >& ind, const std::vector<std::vector<double> >& val, const std::vector<double>& rhs, std::vector<double>& result, double& objval) const {
+		return U.solveCplexLP(obj, ind, val, rhs, result, objval);
+	}
+};
+
+//---------------------------------------------------------------------------//
+
+const std::vector<const UncertaintySet::LPBackend*>& UncertaintySet::lpBackends() {
+	static const DenseBackend dense;
+	static const CplexBackend cplex;
+	static const std::vector<const LPBackend*> backends = USE_DENSE_SIMPLEX ? std::vector<const LPBackend*>{&dense, &cplex} : std::vector<const LPBackend*>{&cplex};
+	return backends;
+}
+
+//---------------------------------------------------------------------------//
+
+int UncertaintySet::solveLP(const std::vector<double>& obj, const std::vector<std::vector<int> >& ind, const std::vector<std::vector<double> >& val, const std::vector<double>& rhs, std::vector<double>& result, double& objval) const {
+	int lpstat = LP_NOT_SOLVED;
+
+	// first backend that solves the LP
+	if (!CROSSCHECK_LP_BACKENDS) {
+		for (const LPBackend* B : lpBackends()) {
+			lpstat = B->solve(*this, obj, ind, val, rhs, result, objval);
+			if (lpstat == CPX_STAT_OPTIMAL) break;
+		}
+		return lpstat;
+	}
+
+	// all backends; optimal values must agree with the first one that solves the LP (the result of the last one is returned)
+	const LPBackend* first = NULL;
+	double firstVal = 0;
+	for (const LPBackend* B : lpBackends()) {
+		lpstat = B->solve(*this, obj, ind, val, rhs, result, objval);
+		if (!first) {
+			if (lpstat == CPX_STAT_OPTIMAL) { first = B; firstVal = objval; }
+			continue;
+		}
+		const double v = (lpstat == CPX_STAT_OPTIMAL) ? objval : std::numeric_limits<double>::quiet_NaN();
+		if (!(std::abs(firstVal - v) <= 1.E-6 * (1.0 + std::abs(v)))) {
+			std::cerr << "Warning: " << first->name() << " and " << B->name() << " disagree on LP over the uncertainty set (" << firstVal << " vs " << v << ").\n";
+		}
+	}
+	return lpstat;
+}
+
+//---------------------------------------------------------------------------//
+
+int UncertaintySet::solveCplexLP(const std::vector<double>& obj, const std::vector<std::vector<int> >& ind, const std::vector<std::vector<double> >& val, const std::vector<double>& rhs, std::vector<double>& result, double& objval) const {
+	assert((int)obj.size() == 1 + N);
+
+	// bring solver objects up to date
+	getSolverLP();
+	syncBounds();
+	result.assign(1 + N, 0);
+
+	// No additional rows: solve lp with the given objective
+	if (rhs.empty()) {
+		std::vector<CPXDIM> CplexIndices(1 + N, 0);
+		std::iota(CplexIndices.begin(), CplexIndices.end(), 0);
+
+		// Replace current objective function
+		const int probtype = CPXXgetprobtype(env, lp);
+		CPXXchgobj(env, lp, (CPXDIM)CplexIndices.size(), &CplexIndices[0], &obj[0]);
+
+		// Set objective sense
+		CPXXchgobjsen(env, lp, CPX_MAX);
+
+		// Solve MILP/LP
+		int lpstat = LP_NOT_SOLVED;
+		switch(probtype) {
+			case CPXPROB_LP: CPXXlpopt(env, lp); lpstat = CPXXgetstat(env, lp); break;
+			case CPXPROB_MILP:
+				CPXXmipopt(env, lp);
+				lpstat = CPXXgetstat(env, lp);
+				if (lpstat == CPXMIP_OPTIMAL || lpstat == CPXMIP_OPTIMAL_TOL) lpstat = CPX_STAT_OPTIMAL;
+				break;
+		}
+
+		// Get optimal value and solution vector
+		CPXXgetobjval(env, lp, &objval);
+		CPXXgetx(env, lp, &result[0], 0, N);
+
+		return lpstat;
+	}
+
+	// Additional rows: persistent separation LP of the row pattern (objective is tau, see solveSeparationLP)
+	assert(obj[0] == 1.0 && std::count(obj.begin(), obj.end(), 0.0) == N);
+	int status;
+	const CPXDIM numrows = ind.size();
+
+	// flatten rows
+	std::vector<CPXDIM> rowlist, collist;
+	std::vector<double> vallist;
+	std::vector<CPXNNZ> rmatbeg;
+	for (CPXDIM p = 0; p < numrows; ++p) {
+		assert(ind[p].size() == val[p].size());
+		rmatbeg.emplace_back(collist.size());
+		rowlist.insert(rowlist.end(), ind[p].size(), p);
+		collist.insert(collist.end(), ind[p].begin(), ind[p].end());
+		vallist.insert(vallist.end(), val[p].begin(), val[p].end());
+	}
+
+	auto it = sepLP.find(ind);
+	if (it == sepLP.end()) {
+		// keep memory bounded
+		if (sepLP.size() >= MAX_SEPARATION_LPS) freeSeparationLPs();
+
+		// Clone LP object of the uncertainty set
+		CPXLPptr sep = CPXXcloneprob(env, lp, &status);
+		if (status || !sep) throw(EXCEPTION_CPXINIT);
+
+		// max tau
+		std::vector<CPXDIM> cols(1 + N, 0);
+		std::iota(cols.begin(), cols.end(), 0);
+		CPXXchgobjsen(env, sep, CPX_MAX);
+		CPXXchgprobtype(env, sep, CPXPROB_LP);
+		CPXXchgobj(env, sep, 1 + N, &cols[0], &obj[0]);
+
+		// tau is free
+		const CPXDIM tau[2] = {0, 0};
+		const char lu[2] = {'L', 'U'};
+		const double bd[2] = {-CPX_INFBOUND, +CPX_INFBOUND};
+		CPXXchgbds(env, sep, 2, tau, lu, bd);
+
+		// separation rows
+		const std::vector<char> sense(numrows, 'L');
+		if (CPXXaddrows(env, sep, 0, numrows, collist.size(), &rhs[0], &sense[0], &rmatbeg[0], &collist[0], &vallist[0], nullptr, nullptr))
+			throw(EXCEPTION_CPXNEWROWS);
+
+		it = sepLP.emplace(ind, sep).first;
+	}
+	else {
+		// same pattern: update coefficients and rhs of the separation rows only
+		const CPXDIM firstrow = CPXXgetnumrows(env, it->second) - numrows;
+		std::vector<CPXDIM> rows(numrows);
+		std::iota(rows.begin(), rows.end(), firstrow);
+		for (auto& r : rowlist) r += firstrow;
+		CPXXchgcoeflist(env, it->second, vallist.size(), &rowlist[0], &collist[0], &vallist[0]);
+		CPXXchgrhs(env, it->second, numrows, &rows[0], &rhs[0]);
+	}
+
+	// Solve LP (from the previous basis if any)
+	CPXLPptr sep = it->second;
+	status = CPXXlpopt(env, sep);
+	if (status) std::cerr << "Could not solve separation LP over the uncertainty set.\n";
+
+	const int lpstat = CPXXgetstat(env, sep);
+	if (lpstat == CPX_STAT_OPTIMAL) {
+		CPXXgetobjval(env, sep, &objval);
+		CPXXgetx(env, sep, &result[0], 0, N);
+	}
+
+	return lpstat;
+}
+
+//---------------------------------------------------------------------------//
+
+//---------------------------------------------------------------------------//
+
+void UncertaintySet::detectStructure() const {
+	structure = STRUCT_GENERAL;
+	structFacets.clear();
+
+	if (N == 0) return;
+
+	// rows 2i-1 and 2i must be the upper and lower bounds of q(i) (see addParam, setXiBar)
+	if ((int)polytope_h->size() < 1 + 2 * N) return;
+	for (int i = 1; i <= N; ++i) {
+		for (int r = 2 * i - 1; r <= 2 * i; ++r) {
+			if (geom->polytope_sense[r] != ((r % 2) ? 'L' : 'G')) return;
+			const RowView W = getRowW(r);
+			if (W.nnz != 1 || W.ind[0] != i || W.val[0] != 1.0) return;
+		}
+	}
+
+	// facets in sparse form
+	for (unsigned r = 1 + 2 * N; r < polytope_h->size(); ++r) {
+		SparseFacet F{0, geom->polytope_sense[r], (*polytope_h)[r], {}};
+		const RowView W = getRowW(r);
+		for (int k = 0; k < W.nnz; ++k) F.terms.emplace_back(W.ind[k], W.val[k]);
+		if (F.terms.empty()) return;
+		structFacets.emplace_back(F);
+	}
+
+	if (structFacets.empty()) {
+		structure = STRUCT_BOX;
+		return;
+	}
+
+	if (structFacets.size() == 1 && structFacets[0].sense != 'E') {
+		structure = STRUCT_BUDGET;
+		return;
+	}
+
+	// factor model: each facet defines its last parameter, which must not appear anywhere else
+	std::vector<bool> isDep(1 + N, false);
+	for (auto& F : structFacets) {
+		if (F.sense != 'E') return;
+		F.dep = F.terms.back().first;
+		if (isDep[F.dep]) return;
+		isDep[F.dep] = true;
+	}
+	for (auto& F : structFacets) {
+		const double a = F.terms.back().second;
+		F.terms.pop_back();
+		for (auto& t : F.terms) {
+			if (isDep[t.first]) return;
+			t.second /= a;
+		}
+		F.rhs /= a;
+	}
+	structure = STRUCT_FACTOR;
+}
+
+//---------------------------------------------------------------------------//
+
+bool UncertaintySet::maxClosedForm(const std::vector<double>& coef, std::vector<double>& result, double& val) const {
+	if (structure == STRUCT_UNKNOWN) detectStructure();
+	if (structure == STRUCT_GENERAL) return false;
+	assert((int)coef.size() == 1 + N);
+
+	// current bounds (possibly tightened by setXiBar)
+	auto lo = [&](const int i) { return (*polytope_h)[2 * i]; };
+	auto hi = [&](const int i) { return (*polytope_h)[2 * i - 1]; };
+	auto finite = [](const double b) { return std::abs(b) < CPX_INFBOUND; };
+
+	result.assign(1 + N, 0.0);
+
+	switch (structure) {
+		case STRUCT_BOX:
+		case STRUCT_FACTOR: {
+			// substitute defined parameters: c'q = const + c_eff'q over the remaining (box) parameters
+			std::vector<double> c(coef);
+			if (structure == STRUCT_FACTOR) for (const auto& F : structFacets) {
+				const double cd = c[F.dep];
+				c[F.dep] = 0;
+				if (cd == 0.0) continue;
+				for (const auto& t : F.terms) c[t.first] -= cd * t.second;
+			}
+
+			// maximize over the box (closest to geom->nominal if indifferent)
+			for (int i = 1; i <= N; ++i) {
+				const double b = (c[i] > 0) ? hi(i) : ((c[i] < 0) ? lo(i) : std::min(std::max(geom->nominal[i], lo(i)), hi(i)));
+				if (!finite(b)) return false;
+				result[i] = b;
+			}
+
+			// recover defined parameters; since their bounds were relaxed, the point is optimal if it satisfies them
+			if (structure == STRUCT_FACTOR) for (const auto& F : structFacets) {
+				double q = F.rhs;
+				for (const auto& t : F.terms) q -= t.second * result[t.first];
+				if (q > hi(F.dep) + 1.E-9 || q < lo(F.dep) - 1.E-9) return false;
+				result[F.dep] = q;
+			}
+			break;
+		}
+		case STRUCT_BUDGET: {
+			// continuous knapsack: write the facet as a'q <= b and flip the parameters with a < 0 so that a >= 0
+			const auto& F = structFacets[0];
+			const double sgnRow = (F.sense == 'G') ? -1.0 : 1.0;
+			double slack = sgnRow * F.rhs;
+			std::vector<double> a(1 + N, 0.0);
+			for (const auto& t : F.terms) a[t.first] = sgnRow * t.second;
+
+			// start from the point that uses the least of the budget
+			std::vector<std::pair<double, int> > items;
+			for (int i = 1; i <= N; ++i) {
+				const double flip = (a[i] < 0) ? -1.0 : 1.0;
+				const double l = (flip > 0) ? lo(i) : -hi(i);
+				const double u = (flip > 0) ? hi(i) : -lo(i);
+				const double ci = flip * coef[i];
+				const double ai = flip * a[i];
+				if (ai == 0.0) {
+					const double b = (ci > 0) ? u : ((ci < 0) ? l : std::min(std::max(flip * geom->nominal[i], l), u));
+					if (!finite(b)) return false;
+					result[i] = flip * b;
+					continue;
+				}
+				if (!finite(l)) return false;
+				result[i] = flip * l;
+				slack -= ai * l;
+				if (ci > 0) items.emplace_back(ci / ai, i);
+			}
+			if (slack < -1.E-9) return false;
+
+			// fill the budget greedily in order of decreasing ratio
+			std::sort(items.begin(), items.end(), [](const std::pair<double, int>& x, const std::pair<double, int>& y) { return x.first > y.first; });
+			for (const auto& it : items) {
+				if (slack <= 0) break;
+				const int i = it.second;
+				const double flip = (a[i] < 0) ? -1.0 : 1.0;
+				const double ai = flip * a[i];
+				const double step = std::min(hi(i) - lo(i), slack / ai);
+				if (!finite(step)) return false;
+				result[i] += flip * step;
+				slack -= ai * step;
+			}
+			break;
+		}
+		default:
+			return false;
+	}
+
+	val = 0;
+	for (int i = 1; i <= N; ++i) val += coef[i] * result[i];
+
+	return true;
+}
 
 //---------------------------------------------------------------------------//
 
+void UncertaintySet::presolve(const std::vector<bool>& observed, PresolvedSet& P) const {
+	P.structureRevision = structureRevision;
+	P.observed = observed;
+	P.valid = false;
+	P.col.clear(); P.obs.clear(); P.mult.clear(); P.off.clear();
+	P.lb.clear(); P.ub.clear();
+	P.rowInd.clear(); P.rowVal.clear(); P.sense.clear(); P.rhs.clear();
+	P.rowObsInd.clear(); P.rowObsVal.clear();
+
+	if (N == 0) return;
+
+	const double TOL = 1.E-9;
+	const auto isInf = [](const double v) { return std::abs(v) >= CPX_INFBOUND; };
+
+	// bounds as in the solver object (see getSolverLP); observed parameters are unbounded here, since
+	// their values are only known at solve time
+	const auto isObs = [&](const int i) { return i <= (int)observed.size() && observed[i-1]; };
+	std::vector<double> l(geom->low), u(geom->high);
+	for (int i = 1; i <= N; ++i) if (isObs(i)) {
+		l[i] = -CPX_INFBOUND;
+		u[i] = +CPX_INFBOUND;
+	}
 
+	// q(i) = off[i] + mult[i] * q(rep[i]); rep[i] = i if q(i) remains, rep[i] = 0 if q(i) is fixed at off[i]
+	std::vector<int> rep(1 + N);
+	std::vector<double> mult(1 + N, 1.0), off(1 + N, 0.0);
+	std::iota(rep.begin(), rep.end(), 0);
+	const auto resolve = [&](int i, double& m, double& o) {
+		m = 1.0; o = 0.0;
+		while (rep[i] != i) {
+			o += m * off[i];
+			m *= mult[i];
+			if (rep[i] == 0) { m = 0.0; return 0; }
+			i = rep[i];
+		}
+		return i;
+	};
+	const auto fix = [&](const int j, const double v) {
+		rep[j] = 0; mult[j] = 0.0; off[j] = v;
+	};
+
+	// all facets in sparse form (the bound rows are already reflected in the bounds)
+	struct Row {
+		std::vector<std::pair<int, double> > terms;
+		char sense;
+		double rhs;
+		bool active;
+	};
+	std::vector<Row> rows;
+	for (const int r : geom->facetRows) {
+		Row R{{}, geom->polytope_sense[r], (*polytope_h)[r], true};
+		const RowView W = getRowW(r);
+		for (int k = 0; k < W.nnz; ++k) R.terms.emplace_back(W.ind[k], W.val[k]);
+		rows.emplace_back(R);
+	}
+
+	// express all rows in terms of the remaining parameters
+	std::vector<double> acc(1 + N, 0.0);
+	std::vector<bool> inRow(1 + N, false);
+	std::vector<int> touched;
+	const auto substitute = [&](Row& R) {
+		touched.clear();
+		for (const auto& t : R.terms) {
+			double m, o;
+			const int j = resolve(t.first, m, o);
+			R.rhs -= t.second * o;
+			if (j == 0 || m == 0.0) continue;
+			if (!inRow[j]) { inRow[j] = true; touched.push_back(j); }
+			acc[j] += t.second * m;
+		}
+		std::sort(touched.begin(), touched.end());
+		R.terms.clear();
+		for (const auto& j : touched) {
+			if (std::abs(acc[j]) > 1.E-12) R.terms.emplace_back(j, acc[j]);
+			acc[j] = 0.0;
+			inRow[j] = false;
+		}
+	};
+
+	// min and max activity of a row over the current bounds (# of infinite contributions counted separately)
+	const auto activity = [&](const Row& R, double& minAct, double& maxAct, int& minInf, int& maxInf) {
+		minAct = maxAct = 0.0; minInf = maxInf = 0;
+		for (const auto& t : R.terms) {
+			const double a = t.second, lo = l[t.first], hi = u[t.first];
+			if (a > 0) {
+				if (isInf(lo)) minInf++; else minAct += a * lo;
+				if (isInf(hi)) maxInf++; else maxAct += a * hi;
+			}
+			else {
+				if (isInf(hi)) minInf++; else minAct += a * hi;
+				if (isInf(lo)) maxInf++; else maxAct += a * lo;
+			}
+		}
+	};
+
+	bool changed = true;
+	for (int pass = 0; changed && pass < 20; ++pass) {
+		changed = false;
+
+		for (auto& R : rows) if (R.active) {
+			substitute(R);
+			const double scale = TOL * (1.0 + std::abs(R.rhs));
+
+			// empty row
+			if (R.terms.empty()) {
+				if ((R.sense != 'G' && R.rhs < -scale) || (R.sense != 'L' && R.rhs > scale)) return;
+				R.active = false;
+				continue;
+			}
+
+			// singleton row: bound (a row on an observed parameter is checked at solve time)
+			if (R.terms.size() == 1 && !isObs(R.terms[0].first)) {
+				const int j = R.terms[0].first;
+				const double a = R.terms[0].second, v = R.rhs / a;
+				if (R.sense == 'E' || (R.sense == 'L') == (a > 0)) u[j] = std::min(u[j], v);
+				if (R.sense == 'E' || (R.sense == 'G') == (a > 0)) l[j] = std::max(l[j], v);
+				R.active = false;
+				changed = true;
+				continue;
+			}
+
+			// 2-term equality: substitute the parameter with the larger coefficient (the later one if tied)
+			if (R.terms.size() == 2 && R.sense == 'E' && !isObs(R.terms[0].first) && !isObs(R.terms[1].first)) {
+				auto tj = R.terms[0], tk = R.terms[1];
+				if (std::abs(tj.second) > std::abs(tk.second)) std::swap(tj, tk);
+				const int j = tj.first, k = tk.first;
+				const double a = tj.second, b = tk.second;
+
+				// q(k) = rhs/b - (a/b) q(j): bounds of q(k) imply bounds of q(j) = (rhs - b q(k))/a
+				if (!isInf(l[k]) && !isInf(u[k])) {
+					const double v1 = (R.rhs - b * l[k]) / a, v2 = (R.rhs - b * u[k]) / a;
+					l[j] = std::max(l[j], std::min(v1, v2));
+					u[j] = std::min(u[j], std::max(v1, v2));
+				}
+				else if (!isInf(l[k]) || !isInf(u[k])) {
+					const double v = (R.rhs - b * (isInf(l[k]) ? u[k] : l[k])) / a;
+					// q(j) moves in direction -b/a as q(k) increases
+					const bool upper = ((b / a > 0) == !isInf(l[k]));
+					if (upper) u[j] = std::min(u[j], v); else l[j] = std::max(l[j], v);
+				}
+				rep[k] = j; mult[k] = -a / b; off[k] = R.rhs / b;
+				R.active = false;
+				changed = true;
+				continue;
+			}
+
+			// redundant or infeasible row
+			double minAct, maxAct; int minInf, maxInf;
+			activity(R, minAct, maxAct, minInf, maxInf);
+			const bool leRedundant = (maxInf == 0 && maxAct <= R.rhs + scale);
+			const bool geRedundant = (minInf == 0 && minAct >= R.rhs - scale);
+			if ((R.sense != 'G' && minInf == 0 && minAct > R.rhs + scale) || (R.sense != 'L' && maxInf == 0 && maxAct < R.rhs - scale)) return;
+			if ((R.sense == 'L' && leRedundant) || (R.sense == 'G' && geRedundant) || (R.sense == 'E' && leRedundant && geRedundant)) {
+				R.active = false;
+				changed = true;
+				continue;
+			}
+
+			// bounds implied by the row
+			for (const auto& t : R.terms) if (!isObs(t.first)) {
+				const int j = t.first;
+				const double a = t.second;
+				for (const double dir : {+1.0, -1.0}) {
+					// dir * row <= dir * rhs
+					if ((dir > 0 && R.sense == 'G') || (dir < 0 && R.sense == 'L')) continue;
+					const int ninf = (dir > 0) ? minInf : maxInf;
+					const double act = (dir > 0) ? minAct : maxAct;
+					const double da = dir * a;
+					const double bj = (da > 0) ? l[j] : u[j];
+					double resid;
+					if (ninf == 0) resid = dir * act - da * bj;
+					else if (ninf == 1 && isInf(bj)) resid = dir * act;
+					else continue;
+					const double v = (dir * R.rhs - resid) / da;
+					if (isInf(v)) continue;
+					if (da > 0 && v + TOL * (1.0 + std::abs(v)) < u[j] - 1.E-7 * (1.0 + std::abs(u[j]))) { u[j] = v + TOL * (1.0 + std::abs(v)); changed = true; }
+					if (da < 0 && v - TOL * (1.0 + std::abs(v)) > l[j] + 1.E-7 * (1.0 + std::abs(l[j]))) { l[j] = v - TOL * (1.0 + std::abs(v)); changed = true; }
+				}
+			}
+		}
 
+		// fix parameters whose bounds meet
+		for (int j = 1; j <= N; ++j) if (rep[j] == j && !isObs(j)) {
+			if (l[j] > u[j] + TOL * (1.0 + std::abs(u[j]))) return;
+			if (l[j] >= u[j]) {
+				fix(j, (l[j] == u[j]) ? l[j] : 0.5 * (l[j] + u[j]));
+				changed = true;
+			}
+		}
+	}
 
+	// duplicate rows (in <= form, scaled): keep the tightest
+	std::map<std::pair<char, std::vector<std::pair<int, double> > >, unsigned> seen;
+	for (unsigned r = 0; r < rows.size(); ++r) if (rows[r].active) {
+		Row& R = rows[r];
+		substitute(R);
+		if (R.terms.empty()) {
+			const double scale = TOL * (1.0 + std::abs(R.rhs));
+			if ((R.sense != 'G' && R.rhs < -scale) || (R.sense != 'L' && R.rhs > scale)) return;
+			R.active = false;
+			continue;
+		}
+		double scale = 0;
+		for (const auto& t : R.terms) scale = std::max(scale, std::abs(t.second));
+		if (R.sense == 'G' || (R.sense == 'E' && R.terms[0].second < 0)) scale = -scale;
+		for (auto& t : R.terms) t.second /= scale;
+		R.rhs /= scale;
+		if (R.sense == 'G') R.sense = 'L';
+
+		const auto it = seen.emplace(std::make_pair(R.sense, R.terms), r);
+		if (it.second) continue;
+		Row& R0 = rows[it.first->second];
+		if (R.sense == 'L') R0.rhs = std::min(R0.rhs, R.rhs);
+		else if (std::abs(R0.rhs - R.rhs) > TOL * (1.0 + std::abs(R.rhs))) return;
+		R.active = false;
+	}
 
+	// reduced form
+	std::vector<int> index(1 + N, -1);
+	for (int j = 1; j <= N; ++j) if (rep[j] == j && !isObs(j)) {
+		index[j] = P.lb.size();
+		P.lb.emplace_back(l[j]);
+		P.ub.emplace_back(u[j]);
+	}
+	P.col.assign(1 + N, -1);
+	P.obs.assign(1 + N, 0);
+	P.mult.assign(1 + N, 0.0);
+	P.off.assign(1 + N, 0.0);
+	for (int i = 1; i <= N; ++i) {
+		const int j = resolve(i, P.mult[i], P.off[i]);
+		if (j == 0) continue;
+		if (isObs(j)) P.obs[i] = j; else P.col[i] = index[j];
+	}
+	for (const auto& R : rows) if (R.active) {
+		P.rowInd.emplace_back();
+		P.rowVal.emplace_back();
+		P.rowObsInd.emplace_back();
+		P.rowObsVal.emplace_back();
+		for (const auto& t : R.terms) {
+			if (isObs(t.first)) {
+				P.rowObsInd.back().emplace_back(t.first);
+				P.rowObsVal.back().emplace_back(t.second);
+				continue;
+			}
+			P.rowInd.back().emplace_back(1 + index[t.first]);
+			P.rowVal.back().emplace_back(t.second);
+		}
+		P.sense.emplace_back(R.sense);
+		P.rhs.emplace_back(R.rhs);
+	}
+	P.valid = true;
+}
 
+//---------------------------------------------------------------------------//
 
+bool UncertaintySet::solveDenseLP(const std::vector<double>& obj, const std::vector<std::vector<int> >& ind, const std::vector<std::vector<double> >& val, const std::vector<double>& rhs, std::vector<double>& result, double& objval) const {
+	// observed parameters are either all fixed at a sample (see setXiBar) or all at their original bounds (see resetXiBar)
+	const std::vector<double>& h = *polytope_h;
+	bool allFixed = true, allFree = true;
+	for (int i = 1; i <= (int)w.size(); ++i) if (w[i-1]) {
+		allFixed = allFixed && (h[2*i] == h[2*i - 1]);
+		allFree = allFree && (h[2*i] == geom->low[i] && h[2*i - 1] == geom->high[i]);
+	}
+	if (!allFixed && !allFree) return false;
+
+	// reduced form of the set (computed once per structure and observation pattern; observed values are filled in below)
+	static const std::vector<bool> NONE_OBSERVED;
+	const std::vector<bool>& observed = allFree ? NONE_OBSERVED : w;
+	PresolvedSet& P = allFree ? presolvedFree : presolvedObs;
+	if (P.structureRevision != structureRevision || P.observed != observed) presolve(observed, P);
+	if (!P.valid) return false;
+	const auto offset = [&](const int i) { return P.off[i] + ((P.obs[i] > 0) ? P.mult[i] * h[2 * P.obs[i]] : 0.0); };
+
+	// size of the tableau (rows x (structural + slack + artificial columns))
+	const int  numcols = 1 + P.lb.size();
+	const long numrows = (long)P.rhs.size() + (long)rhs.size();
+	if (numrows > DENSE_SIMPLEX_MAX_ROWS || numrows * (numcols + 2 * numrows) > DENSE_SIMPLEX_MAX_ENTRIES) return false;
+
+	// objective in terms of (tau, y)
+	assert((int)obj.size() == 1 + N);
+	std::vector<double>& row = denseRow;
+	row.assign(numcols, 0.0);
+	double objConst = 0;
+	row[0] = obj[0];
+	for (int i = 1; i <= N; ++i) if (obj[i] != 0.0) {
+		objConst += obj[i] * offset(i);
+		if (P.col[i] >= 0) row[1 + P.col[i]] += obj[i] * P.mult[i];
+	}
 
+	denseLP.reset(numcols, CPX_INFBOUND);
+	denseLP.setColumn(0, row[0], -CPX_INFBOUND, +CPX_INFBOUND);
+	for (int j = 1; j < numcols; ++j) {
+		denseLP.setColumn(j, row[j], P.lb[j - 1], P.ub[j - 1]);
+	}
+	for (unsigned r = 0; r < P.rhs.size(); ++r) {
+		double b = P.rhs[r];
+		for (unsigned k = 0; k < P.rowObsInd[r].size(); ++k) b -= P.rowObsVal[r][k] * h[2 * P.rowObsInd[r][k]];
+
+		// facet only on observed parameters: check it here
+		if (P.rowInd[r].empty()) {
+			const double scale = 1.E-9 * (1.0 + std::abs(b));
+			if ((P.sense[r] != 'G' && b < -scale) || (P.sense[r] != 'L' && b > scale)) return false;
+			continue;
+		}
+		denseLP.addRow(P.rowInd[r].size(), &P.rowInd[r][0], &P.rowVal[r][0], P.sense[r], b);
+	}
 
+	// additional rows in terms of (tau, y)
+	for (unsigned p = 0; p < rhs.size(); ++p) {
+		assert(ind[p].size() == val[p].size());
+		row.assign(numcols, 0.0);
+		double r = rhs[p];
+		for (unsigned k = 0; k < ind[p].size(); ++k) {
+			const int i = ind[p][k];
+			if (i == 0) { row[0] += val[p][k]; continue; }
+			r -= val[p][k] * offset(i);
+			if (P.col[i] >= 0) row[1 + P.col[i]] += val[p][k] * P.mult[i];
+		}
+		denseLP.addRow(&row[0], 'L', r);
+	}
 
+	if (denseLP.solve() != DenseSimplex::OPTIMAL) return false;
 
+	// map the solution back to (tau, q)
+	denseLP.getX(row);
+	result.assign(1 + N, 0.0);
+	result[0] = row[0];
+	for (int i = 1; i <= N; ++i) {
+		result[i] = offset(i) + ((P.col[i] >= 0) ? P.mult[i] * row[1 + P.col[i]] : 0.0);
+	}
+	objval = denseLP.getObjValue() + objConst;
+	return true;
+}